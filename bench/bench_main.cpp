@@ -0,0 +1,750 @@
+/**
+ * =====================================================================
+ * myS3XY-Lightshow: native frame pipeline benchmark
+ * =====================================================================
+ * Runs the ShowEngine on the host (pio run -e native, then
+ * .pio/build/native/program [show.fseq ...]).
+ *
+ * Without arguments it builds synthetic shows in memory (V1, V2 zlib,
+ * V2 sparse, from test/ShowFixtures.h) and times the pipeline stages.
+ * Real show files can be passed as arguments. Correctness is checked by
+ * the Unity suites (pio test -e native); this program only measures.
+ * Host timings are relative: the ESP32-C3 is roughly 20-50x slower.
+ * =====================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include "FseqReader.h"
+#include "ChannelMapper.h"
+#include "DeltaCodec.h"
+#include "FrameClock.h"
+#include "TimeSync.h"
+#include "ChannelAnalyzer.h"
+#include "ShowSlot.h"
+#include "FileIndex.h"
+#include "LedOutput.h"
+#include "PowerScale.h"
+#include "PipelineMetrics.h"
+#include <dirent.h>
+#include <string>
+#include <sys/stat.h>
+#include "Platform.h"
+#include "../test/ShowFixtures.h"
+
+// --- Measurements ---
+
+struct ReadStats {
+  double avgUs = 0;
+  uint32_t maxUs = 0;
+  bool ok = true;
+};
+
+/**
+ * Reads every frame in order, as the reader task does during a show.
+ */
+static ReadStats timeSequentialRead(FseqReader& reader) {
+    ReadStats s;
+    static uint8_t logical[LOGICAL_CHANNELS];
+    memset(logical, 0, sizeof(logical));
+
+    uint64_t total = 0;
+    uint32_t frames = reader.info().frameCount;
+    for (uint32_t f = 0; f < frames; f++) {
+        uint32_t t0 = engineMicros();
+        if (!reader.readFrame(f, logical)) { s.ok = false; break; }
+        uint32_t dt = engineMicros() - t0;
+        total += dt;
+        s.maxUs = std::max(s.maxUs, dt);
+    }
+    s.avgUs = frames ? total / (double)frames : 0;
+    return s;
+}
+
+/**
+ * Worst-case seek: the last frame of every block, out of order.
+ */
+static double timeRandomSeek(FseqReader& reader) {
+    static uint8_t logical[LOGICAL_CHANNELS];
+    uint32_t frames = reader.info().frameCount;
+    uint32_t n = 0;
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < 64; i++) {
+        uint32_t f = (uint32_t)(((uint64_t)i * 7919 * FIXTURE_BLOCK) % frames) | (FIXTURE_BLOCK - 1);
+        if (f >= frames) continue;
+        uint32_t t0 = engineMicros();
+        reader.readFrame(f, logical);
+        total += engineMicros() - t0;
+        n++;
+    }
+    return n ? total / (double)n : 0;
+}
+
+/**
+ * Late join: open the show, seek to a mid-show frame and read the ring
+ * prefill (8 frames), as the firmware does before its first frame.
+ */
+static bool timeLateJoin(const char* name, ByteSource* src) {
+    static uint8_t logical[LOGICAL_CHANNELS];
+    const uint32_t joins = 32, prefill = 8;
+    uint64_t total = 0;
+    uint32_t worst = 0;
+    for (uint32_t j = 0; j < joins; j++) {
+        uint32_t t0 = engineMicros();
+        FseqReader reader;
+        if (!reader.open(src)) return false;
+        uint32_t first = (uint32_t)((uint64_t)(j + 1) * (reader.info().frameCount - prefill) / (joins + 1)) | 1;
+        for (uint32_t f = first; f < first + prefill; f++) {
+            if (!reader.readFrame(f, logical)) return false;
+        }
+        uint32_t us = engineMicros() - t0;
+        total += us;
+        if (us > worst) worst = us;
+    }
+    printf("%-14s late join: open + seek + %u-frame prefill avg %.1f us, max %u us\n", name, prefill,
+           total / (double)joins, worst);
+    return true;
+}
+
+static void printRead(const char* name, FseqReader& reader, const ReadStats& s) {
+    const FseqInfo& info = reader.info();
+    double budgetUs = info.stepTimeMs * 1000.0;
+    printf("%-14s %5u ch x %5u frames | read avg %7.2f us, max %6u us | %6.3f%% of %u ms step%s\n",
+           name, info.channelCount, info.frameCount, s.avgUs, s.maxUs,
+           100.0 * s.avgUs / budgetUs, info.stepTimeMs, s.ok ? "" : " | READ FAILED");
+}
+
+/**
+ * Converts an open show to .lsq in memory and reads it back.
+ */
+static bool benchDelta(const char* name, FseqReader& reader, uint32_t srcSize) {
+    MemorySink sink;
+    DeltaStats stats;
+    if (!encodeDeltaShow(reader, sink, stats)) {
+        printf("%-14s delta encode FAILED at frame %u (%s)\n", name, stats.failedFrame, reader.lastError());
+        return false;
+    }
+    MemorySource lsq(sink.data.data(), sink.data.size());
+    FseqReader delta;
+    if (!delta.open(&lsq)) {
+        printf("%-14s delta reopen FAILED (%s)\n", name, delta.lastError());
+        return false;
+    }
+    ReadStats s = timeSequentialRead(delta);
+    printf("%-14s delta %8u -> %7u bytes (ratio %5.2f:1, max record %u) | decode avg %6.2f us, max %u us%s\n",
+           name, srcSize, stats.bytesOut, srcSize / (double)stats.bytesOut, stats.maxRecord,
+           s.avgUs, s.maxUs, s.ok ? "" : " | READ FAILED");
+    char lsqName[32];
+    snprintf(lsqName, sizeof(lsqName), "%s .lsq", name);
+    return timeLateJoin(lsqName, &lsq) && s.ok;
+}
+
+/**
+ * Offline analyzer over a whole show, plus its report.
+ */
+static bool benchAnalyzer(const char* name, FseqReader& reader) {
+    ChannelAnalysis analysis;
+    if (!analyzeChannels(reader, analysis)) {
+        printf("%-14s analyzer FAILED at frame %u (%s)\n", name, analysis.failedFrame, reader.lastError());
+        return false;
+    }
+    MemorySink report;
+    bool ok = writeChannelReport(analysis, name, report);
+    printf("%-14s analyzer: %u frames in %.1f ms (%.0fx show speed), report %u bytes\n", name,
+           analysis.frames, analysis.scanUs / 1000.0,
+           analysis.frames * analysis.stepTimeMs * 1000.0 / std::max(analysis.scanUs, 1u), (unsigned)report.data.size());
+    return ok;
+}
+
+/**
+ * Counts what the reader pulls from the underlying source.
+ */
+class CountingSource : public ByteSource {
+public:
+    explicit CountingSource(ByteSource* src) : _src(src) {}
+    uint32_t size() override { return _src->size(); }
+    size_t readAt(uint32_t offset, uint8_t* dst, size_t len) override {
+        calls++;
+        size_t n = _src->readAt(offset, dst, len);
+        bytes += n;
+        return n;
+    }
+    uint64_t bytes = 0;
+    uint32_t calls = 0;
+
+private:
+    ByteSource* _src;
+};
+
+/**
+ * Full-stride reads vs. range reads of the sample config's channels, from
+ * a real file so every read pays a seek.
+ */
+static bool benchRangeReads(const char* name, const std::vector<uint8_t>& show) {
+    const char* path = "/tmp/bench_range.fseq";
+    FILE* f = fopen(path, "wb");
+    if (!f || fwrite(show.data(), 1, show.size(), f) != show.size()) {
+        if (f) fclose(f);
+        printf("%-14s range reads: cannot write %s\n", name, path);
+        return false;
+    }
+    fclose(f);
+
+    std::vector<uint16_t> used(sampleChannels, sampleChannels + 25);
+    static const int gaps[] = { -1, 0, 16, FSEQ_READ_GAP };   // -1: full stride
+    static uint8_t logical[LOGICAL_CHANNELS];
+    bool ok = true;
+
+    for (int gap : gaps) {
+        StdioFileSource file;
+        CountingSource src(&file);
+        FseqReader reader;
+        if (!file.open(path) || !reader.open(&src)) return false;
+        std::vector<ChannelRange> ranges;
+        if (gap >= 0) ranges = coalesceChannels(used, gap);
+        reader.setReadRanges(ranges);
+
+        memset(logical, 0, sizeof(logical));
+        src.bytes = 0;
+        src.calls = 0;
+        uint32_t frames = reader.info().frameCount;
+        uint32_t t0 = engineMicros();
+        for (uint32_t fr = 0; fr < frames && ok; fr++) {
+            if (!reader.readFrame(fr, logical)) ok = false;
+        }
+        uint32_t us = engineMicros() - t0;
+
+        char label[32];
+        if (gap < 0) snprintf(label, sizeof(label), "full stride");
+        else snprintf(label, sizeof(label), "gap %3d, %2u ranges", gap, (unsigned)ranges.size());
+        printf("%-14s %-20s | %4.0f bytes, %4.1f reads per frame | read avg %5.2f us\n", name, label,
+               src.bytes / (double)frames, src.calls / (double)frames, us / (double)frames);
+    }
+    remove(path);
+    return ok;
+}
+
+/**
+ * Playback of the sample config from a file (the LittleFS path: seek and
+ * read into a frame buffer) vs. the same show memory mapped, copied and
+ * zero-copy (mapping straight from the mapped frame, as from the flash
+ * slot).
+ */
+static bool benchMappedPlayback(const std::vector<uint8_t>& show) {
+    const char* path = "/tmp/bench_slot.fseq";
+    FILE* f = fopen(path, "wb");
+    bool ok = f && fwrite(show.data(), 1, show.size(), f) == show.size();
+    if (f) fclose(f);
+    if (!ok) return false;
+
+    std::vector<LedMapping> mapping(25);
+    for (uint16_t i = 0; i < 25; i++) mapping[i].channel = sampleChannels[i];
+    std::vector<uint16_t> src(25);
+    std::vector<uint8_t> color(25);
+    LedMapTable map = { src.data(), color.data(), defaultColorLuts(), 25 };
+    compileLedMap(mapping, map);
+
+    StdioFileSource file;
+    MappedFileSource mapped;
+    FseqReader fileReader, mappedReader;
+    if (!file.open(path) || !mapped.open(path) || !fileReader.open(&file) || !mappedReader.open(&mapped)) {
+        remove(path);
+        return false;
+    }
+    uint32_t frames = fileReader.info().frameCount;
+    static uint8_t logical[LOGICAL_CHANNELS];
+    std::vector<Rgb> out(25);
+
+    const char* names[] = { "file read", "mapped, copied", "mapped, zero-copy" };
+    for (int mode = 0; mode < 3; mode++) {
+        FseqReader& reader = mode == 0 ? fileReader : mappedReader;
+        bool read = true;
+        uint32_t t0 = engineMicros();
+        for (uint32_t fr = 0; fr < frames; fr++) {
+            const uint8_t* frame = mode == 2 ? reader.directFrame(fr) : logical;
+            if (mode < 2 && !reader.readFrame(fr, logical)) frame = nullptr;
+            if (!frame) { read = false; break; }
+            mapFrameToLeds(frame, map, out.data());
+        }
+        uint32_t us = engineMicros() - t0;
+        printf("V1 %-17s read + map 25 LEDs avg %5.3f us per frame%s\n", names[mode], us / (double)frames,
+               read ? "" : " | READ FAILED");
+        ok = ok && read;
+    }
+
+    remove(path);
+    return ok;
+}
+
+/**
+ * Power sidecar for 100 LEDs at brightness 128 and 500 mA: compile time,
+ * and the per-frame estimate the render path no longer has to make.
+ */
+static bool benchPowerScale(const std::vector<uint8_t>& show) {
+    const uint16_t n = 100;
+    const uint8_t brightness = 128;
+    const uint32_t maxMw = POWER_VOLTS * 500;
+
+    std::vector<LedMapping> mapping(n);
+    for (uint16_t i = 0; i < n; i++) mapping[i].channel = sampleChannels[i % 25];
+    std::vector<uint16_t> src(n);
+    std::vector<uint8_t> color(n);
+    LedMapTable map = { src.data(), color.data(), defaultColorLuts(), n };
+    compileLedMap(mapping, map);
+
+    MemorySource source(show.data(), show.size());
+    FseqReader reader;
+    if (!reader.open(&source)) return false;
+    uint32_t frames = reader.info().frameCount;
+
+    PowerHeader header;
+    header.frameCount = frames;
+    MemorySink sink;
+    PowerStats stats;
+    uint32_t t0 = engineMicros();
+    bool ok = compilePowerScales(reader, map, brightness, maxMw, header, sink, stats);
+    uint32_t compileUs = engineMicros() - t0;
+
+    // What the render path did per frame before: estimate from the pixels
+    static uint8_t frame[LOGICAL_CHANNELS];
+    std::vector<Rgb> pixels(n);
+    uint32_t estimateUs = 0;
+    volatile uint8_t kept = 0;   // Keeps the estimate loop from being dropped
+    for (uint32_t f = 0; ok && f < frames; f++) {
+        ok = reader.readFrame(f, frame);
+        mapFrameToLeds(frame, map, pixels.data());
+        uint32_t t = engineMicros();
+        for (int k = 0; k < 100; k++) kept = limitBrightness(unscaledPowerMw(pixels.data(), n), brightness, maxMw);
+        estimateUs += engineMicros() - t;
+    }
+    (void)kept;
+    printf("power plan %u frames in %.1f ms: %u limited (lowest %u of %u) | estimate %.3f us/frame, "
+           "lookup 1 byte\n", frames, compileUs / 1000.0, stats.limitedFrames, stats.minBrightness,
+           brightness, estimateUs / (100.0 * std::max(frames, 1u)));
+    return ok;
+}
+
+/**
+ * Boot/listing with 36 files: walking the directory and opening every
+ * file (the old path) vs. loading the saved index.
+ */
+static bool benchFileIndex(const std::vector<uint8_t>& v1, const std::vector<uint8_t>& v2z) {
+    const char* dir = "/tmp/bench_index";
+    mkdir(dir, 0755);
+    char path[300];
+    const char* config = "{\"name\":\"RC_S3XY_Compact_25\",\"leds\":[{\"channel\":139},{\"channel\":164}]}";
+    for (int i = 0; i < 36; i++) {
+        const uint8_t* data = (const uint8_t*)config;
+        size_t len = strlen(config);
+        if (i % 3 == 0) { snprintf(path, sizeof(path), "%s/show_%02d.fseq", dir, i); data = v1.data(); len = v1.size(); }
+        else if (i % 3 == 1) { snprintf(path, sizeof(path), "%s/show_%02d.fseq", dir, i); data = v2z.data(); len = v2z.size(); }
+        else snprintf(path, sizeof(path), "%s/config_%02d.json", dir, i);
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        fwrite(data, 1, len, f);
+        fclose(f);
+    }
+
+    // 1. Old path: walk, stat and open every file
+    FileIndex index;
+    uint32_t t0 = engineMicros();
+    DIR* d = opendir(dir);
+    while (struct dirent* e = d ? readdir(d) : nullptr) {
+        if (e->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+        struct stat st;
+        stat(path, &st);
+        FileRecord rec;
+        memcpy(rec.name, e->d_name, strnlen(e->d_name, sizeof(rec.name) - 1));
+        rec.size = st.st_size;
+        rec.kind = fileKindOf(rec.name);
+        if (rec.kind == FILE_KIND_SHOW) {
+            StdioFileSource src;
+            FseqReader reader;
+            if (src.open(path) && reader.open(&src)) describeShow(rec, reader.info());
+        } else if (rec.kind == FILE_KIND_CONFIG) {
+            char buf[256];
+            FILE* f = fopen(path, "rb");
+            size_t n = f ? fread(buf, 1, sizeof(buf) - 1, f) : 0;
+            if (f) fclose(f);
+            buf[n] = 0;
+            snprintf(rec.label, sizeof(rec.label), "RC_S3XY_Compact_25");
+            for (const char* c = buf; (c = strstr(c, "channel")); c++) rec.leds++;
+        }
+        index.put(rec);
+    }
+    if (d) closedir(d);
+    uint32_t walkUs = engineMicros() - t0;
+
+    snprintf(path, sizeof(path), "%s/files.lsi", dir);
+    StdioFileSink sink;
+    bool ok = sink.open(path) && index.save(sink);
+    sink.close();
+
+    // 2. Index path: one small file
+    FileIndex loaded;
+    t0 = engineMicros();
+    StdioFileSource src;
+    ok = ok && src.open(path) && loaded.load(src);
+    uint32_t loadUs = engineMicros() - t0;
+    src.close();
+
+    printf("36 files: walk + open each %.2f ms | load index (%u bytes) %.3f ms%s\n", walkUs / 1000.0,
+           FILE_INDEX_HEADER + 36 * FILE_INDEX_RECORD, loadUs / 1000.0, ok ? "" : " | FAILED");
+
+    for (const FileRecord& r : index.records()) {
+        snprintf(path, sizeof(path), "%s/%s", dir, r.name);
+        remove(path);
+    }
+    snprintf(path, sizeof(path), "%s/files.lsi", dir);
+    remove(path);
+    rmdir(dir);
+    return ok;
+}
+
+/**
+ * Legacy branchy mapping vs. compiled LED map (same kernel as the firmware).
+ */
+static void benchMapping() {
+    static const uint16_t sizes[] = { 25, 100, 1000 };
+    const uint32_t rounds = 20000;
+
+    static uint8_t frame[LOGICAL_CHANNELS];
+    for (int i = 0; i < LOGICAL_CHANNELS; i++) frame[i] = (i * 37) & 0xFF;
+
+    for (uint16_t n : sizes) {
+        std::vector<LedMapping> mapping(n);
+        for (uint16_t i = 0; i < n; i++) mapping[i].channel = sampleChannels[i % 25];
+
+        std::vector<Rgb> legacy(n), scaled(n), compiled(n);
+        std::vector<uint16_t> src(n);
+        std::vector<uint8_t> color(n), sr(n), sg(n), sb(n);
+        LedMapTable map = { src.data(), color.data(), defaultColorLuts(), n };
+        compileLedMap(mapping, map);
+        ColorProfile builtin = defaultColorProfile();
+        for (uint16_t i = 0; i < n; i++) {
+            sr[i] = builtin.classes[color[i]].tint[0];
+            sg[i] = builtin.classes[color[i]].tint[1];
+            sb[i] = builtin.classes[color[i]].tint[2];
+        }
+
+        uint32_t t0 = engineMicros();
+        for (uint32_t r = 0; r < rounds; r++) {
+            frame[r & 511] = r;  // Keep the loop from being hoisted
+            for (uint16_t i = 0; i < n; i++) {
+                uint16_t rawCh = mapping[i].channel;
+                uint8_t val = (rawCh < 1024) ? frame[rawCh] : 0;
+                if (rawCh == 139 || rawCh == 142 || rawCh == 339 || rawCh == 342) legacy[i] = { val, (uint8_t)((val * 160) >> 8), 0 };
+                else if ((rawCh >= 364 && rawCh <= 371) || rawCh == 392) legacy[i] = { val, 0, 0 };
+                else if (rawCh >= 151 && rawCh <= 160) legacy[i] = { (uint8_t)((val * 100) >> 8), (uint8_t)((val * 100) >> 8), val };
+                else legacy[i] = { val, val, val };
+            }
+        }
+        uint32_t legacyUs = engineMicros() - t0;
+
+        // Per-LED multiply-shift scales (the kernel before color tables)
+        t0 = engineMicros();
+        for (uint32_t r = 0; r < rounds; r++) {
+            frame[r & 511] = r;
+            for (uint16_t i = 0; i < n; i++) {
+                uint16_t val = frame[src[i]];
+                scaled[i].r = (val * (sr[i] + 1)) >> 8;
+                scaled[i].g = (val * (sg[i] + 1)) >> 8;
+                scaled[i].b = (val * (sb[i] + 1)) >> 8;
+            }
+        }
+        uint32_t scaledUs = engineMicros() - t0;
+
+        t0 = engineMicros();
+        for (uint32_t r = 0; r < rounds; r++) {
+            frame[r & 511] = r;
+            mapFrameToLeds(frame, map, compiled.data());
+        }
+        uint32_t compiledUs = engineMicros() - t0;
+
+        printf("map %4u LEDs: legacy %8.3f | scale %8.3f | table %8.3f us/frame\n", n,
+               legacyUs / (double)rounds, scaledUs / (double)rounds, compiledUs / (double)rounds);
+    }
+}
+
+/**
+ * Interpolation kernel for 100 LEDs at 100 Hz: the kernel (scaled to the
+ * slowest C3 estimate) plus the WS2812 transmit time against one 10 ms
+ * output tick.
+ */
+static void benchInterpolation() {
+    const uint16_t n = 100, hz = 100;
+    const uint32_t rounds = 20000;
+    const double wireUsPerLed = 30.0;   // 24 bits x 1.25 us
+    const double latchUs = 280.0;       // Reset gap of current WS2812B parts
+    const double deviceFactor = 50.0;   // Upper end of the host/C3 estimate
+
+    static uint8_t from[LOGICAL_CHANNELS], to[LOGICAL_CHANNELS];
+    for (int i = 0; i < LOGICAL_CHANNELS; i++) {
+        from[i] = (i * 37) & 0xFF;
+        to[i] = (i * 91 + 13) & 0xFF;
+    }
+
+    std::vector<LedMapping> mapping(n);
+    for (uint16_t i = 0; i < n; i++) mapping[i].channel = sampleChannels[i % 25];
+    std::vector<uint16_t> src(n);
+    std::vector<uint8_t> color(n);
+    LedMapTable map = { src.data(), color.data(), defaultColorLuts(), n };
+    compileLedMap(mapping, map);
+    std::vector<Rgb> blended(n);
+
+    // 1. Cost per LED
+    uint32_t t0 = engineMicros();
+    for (uint32_t r = 0; r < rounds; r++) {
+        from[r & 511] = r;  // Keep the loop from being hoisted
+        blendFrameToLeds(from, to, r & 255, map, blended.data());
+    }
+    double kernelUs = (engineMicros() - t0) / (double)rounds;
+
+    // 2. Budget of one output tick on the device
+    double tickUs = 1e6 / hz;
+    double wireUs = n * wireUsPerLed + latchUs;
+    double deviceUs = kernelUs * deviceFactor;
+    bool fits = deviceUs + wireUs < tickUs;
+    printf("blend %u LEDs: %.3f us/frame (%.2f ns/LED)\n", n, kernelUs, kernelUs * 1000 / n);
+    printf("%u Hz tick %.0f us: kernel x%.0f %.0f us + WS2812 %.0f us = %.0f us (%.0f%%) | %s\n", hz, tickUs,
+           deviceFactor, deviceUs, wireUs, deviceUs + wireUs, (deviceUs + wireUs) * 100 / tickUs,
+           fits ? "fits" : "TOO SLOW");
+}
+
+/**
+ * LED output layouts at 20 ms frames through the mock driver: one pin
+ * against strips on both RMT transmitters.
+ */
+static void benchLedOutput() {
+    struct Layout { const char* name; uint16_t leds; std::vector<uint16_t> strips; };
+    const Layout layouts[] = {
+        { "100 LEDs, 1 pin", 100, { 100 } },
+        { "600 LEDs, 1 pin", 600, { 600 } },
+        { "1000 LEDs, 1 pin", 1000, { 1000 } },
+        { "1000 LEDs, 2 pins", 1000, { 500, 500 } },
+        { "1000 LEDs, 4 pins", 1000, { 250, 250, 250, 250 } },
+        { "1024 LEDs, 3 pins", 1024, { 400, 400, 224 } },
+    };
+    const uint32_t frames = 500, stepUs = FIXTURE_STEP_MS * 1000;
+
+    for (const Layout& l : layouts) {
+        std::vector<LedStrip> strips;
+        for (uint16_t n : l.strips) {
+            LedStrip s;
+            s.pin = strips.size();
+            s.count = n;
+            strips.push_back(s);
+        }
+        layoutStrips(strips, l.leds, 0);
+        uint32_t wireUs = outputWireUs(strips);
+        bool fits = wireUs < stepUs;
+
+        MockLedOutput out;
+        out.begin(strips);
+        for (uint32_t f = 0; f < frames; f++) {
+            out.setNow((uint64_t)f * stepUs);
+            out.show(255);
+        }
+        printf("%-18s wire %5u us of %u | max busy %5u us | stalls %3u | %s\n", l.name, wireUs, stepUs,
+               out.maxBusyUs(), out.stalls(), fits ? "fits" : "TOO SLOW");
+    }
+}
+
+/**
+ * Frame clock against a simulated loop() that comes around every 0-3 ms,
+ * with one 200 ms stall (e.g. a flash erase). A relative scheduler
+ * (next = last release + step) is run alongside to show the drift the
+ * absolute deadlines avoid.
+ */
+static void benchFrameClock() {
+    const uint64_t showUs = 3600ULL * 1000000ULL;   // One hour
+    FrameClock clock;
+    clock.start(0, FIXTURE_STEP_MS);
+
+    uint64_t relativeNext = 0, relativeFrames = 0;
+    srand(7);
+    for (uint64_t now = 0; now < showUs; now += 1 + (rand() % 3000)) {
+        if (now >= 5000000 && now < 5200000) continue;
+        if (clock.poll(now)) clock.advance();
+        if (now >= relativeNext) { relativeNext = now + FIXTURE_STEP_MS * 1000; relativeFrames++; }
+    }
+
+    printf("clock: 1 h, loop period 0-3 ms, one 200 ms stall -> frame %u (ideal %u), %u skipped\n",
+           clock.current(), (unsigned)(showUs / (FIXTURE_STEP_MS * 1000)), clock.skipped());
+    printf("clock: lateness avg %u us, max %u us |", clock.avgLateUs(), clock.maxLateUs());
+    for (uint8_t i = 0; i < FRAME_CLOCK_BUCKETS; i++) {
+        uint32_t limit = FrameClock::bucketLimitUs(i);
+        if (limit) printf(" <%uus %u", limit, clock.lateness()[i]);
+        else printf(" more %u", clock.lateness()[i]);
+    }
+    printf("\nclock: relative scheduler reached frame %u -> drift %.1f s\n", (unsigned)relativeFrames,
+           (showUs / (FIXTURE_STEP_MS * 1000.0) - relativeFrames) * FIXTURE_STEP_MS / 1000.0);
+}
+
+/**
+ * Stage histograms: one sample has to stay cheap enough to record on
+ * every frame (a few per frame on the render task).
+ */
+static void benchMetrics() {
+    PipelineMetrics metrics;
+    const uint32_t samples[] = { 10, 50, 51, 400, 999, 30000, 70000 };
+    for (uint32_t us : samples) metrics.add(STAGE_MAP, us);
+
+    MemorySink sink;
+    metrics.writePrometheus(sink, "lightshow_stage_seconds", "Time per frame pipeline stage");
+    // Recording cost
+    const uint32_t rounds = 1000000;
+    PipelineMetrics timed;
+    uint32_t t0 = engineMicros();
+    for (uint32_t i = 0; i < rounds; i++) timed.add(STAGE_FRAME, (i * 2654435761u) >> 16);
+    uint32_t addUs = engineMicros() - t0;
+
+    printf("metrics: %zu bytes of Prometheus text for %d stages | %.1f ns per sample\n", sink.data.size(),
+           STAGE_COUNT, addUs * 1000.0 / rounds);
+}
+
+/**
+ * Browser clock sync against a simulated WiFi link: 12 rounds per sync,
+ * 3-30 ms path latency per link, 0-12 ms jitter per leg, one leg in four
+ * hit by a 50-250 ms stall (power save, retries), browser timestamps
+ * rounded to 1 ms. The legacy sync (whole browser seconds, applied on
+ * arrival) is run on the same links.
+ */
+static void benchTimeSync() {
+    const int trials = 1000, rounds = 12;
+    srand(11);
+    int64_t path = 0;
+    auto leg = [&path]() -> int64_t {
+        int64_t us = path + rand() % 12000;
+        if (rand() % 4 == 0) us += 50000 + rand() % 200000;
+        return us;
+    };
+    auto ms = [](int64_t us) { return us / 1000 * 1000; };
+
+    double sumErr = 0, sumLegacy = 0;
+    int64_t maxErr = 0, maxLegacy = 0;
+    for (int t = 0; t < trials; t++) {
+        int64_t trueOffset = (int64_t)(rand() % 10000000) - 5000000;   // Controller - browser
+        int64_t browser = 1700000000000000LL + (int64_t)rand() * 1000;
+        path = 3000 + rand() % 27000;
+
+        TimeSyncSample samples[rounds];
+        for (int r = 0; r < rounds; r++) {
+            int64_t up = leg(), down = leg(), work = 100 + rand() % 2000;
+            samples[r].t1 = ms(browser);
+            samples[r].t2 = browser + up + trueOffset;
+            samples[r].t3 = samples[r].t2 + work;
+            browser += up + work + down;
+            samples[r].t4 = ms(browser);
+            browser += 1000 + rand() % 5000;   // Next fetch
+        }
+        TimeSyncResult res = estimateClockOffset(samples, rounds);
+        int64_t err = llabs(res.offsetUs - trueOffset);
+        sumErr += err;
+        if (err > maxErr) maxErr = err;
+
+        // Legacy: controller clock := floor(browser seconds) when the request arrives
+        int64_t legacy = (browser % 1000000) + leg();
+        sumLegacy += legacy;
+        if (legacy > maxLegacy) maxLegacy = legacy;
+    }
+
+    printf("sync: %d syncs x %d rounds -> offset error avg %.2f ms, max %.2f ms\n", trials, rounds,
+           sumErr / trials / 1000.0, maxErr / 1000.0);
+    printf("sync: legacy whole-second sync -> error avg %.1f ms, max %.1f ms\n", sumLegacy / trials / 1000.0,
+           maxLegacy / 1000.0);
+
+}
+
+static bool benchFile(const char* path) {
+    StdioFileSource file;
+    FseqReader reader;
+    if (!file.open(path) || !reader.open(&file)) {
+        printf("%s: %s\n", path, file.size() ? reader.lastError() : "cannot open");
+        return false;
+    }
+    const FseqInfo& info = reader.info();
+    printf("%s: V%u, compression %u, stride %u, %u ranges, %u blocks, media '%s'\n", path, info.version,
+           info.compression, info.stride, info.rangeCount, info.blockCount, info.mediaFile.c_str());
+
+    ReadStats s = timeSequentialRead(reader);
+    printRead("  sequential", reader, s);
+    if (info.compression == FSEQ_COMPRESSION_ZLIB) printf("  random seek    avg %.2f us\n", timeRandomSeek(reader));
+    if (info.compression == FSEQ_COMPRESSION_NONE) benchDelta("  ", reader, file.size());
+    return s.ok;
+}
+
+int main(int argc, char** argv) {
+    bool ok = true;
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) ok = benchFile(argv[i]) && ok;
+        return ok ? 0 : 1;
+    }
+
+    printf("--- Show formats (%u channels, %u frames, %u ms) ---\n", FIXTURE_CHANNELS, FIXTURE_FRAMES, FIXTURE_STEP_MS);
+    std::vector<uint8_t> frames = makeFrames(FIXTURE_FRAMES, FIXTURE_CHANNELS);
+
+    std::vector<uint8_t> v1 = buildV1(frames, FIXTURE_CHANNELS, FIXTURE_FRAMES);
+    std::vector<uint8_t> v2z = buildV2(frames, FIXTURE_CHANNELS, FIXTURE_FRAMES, true, {});
+    std::vector<uint8_t> sparseFrames;
+    std::vector<uint8_t> v2s = buildSparse(frames, FIXTURE_FRAMES, sparseFrames);
+
+    struct Case { const char* name; std::vector<uint8_t>* file; };
+    Case cases[] = { { "V1", &v1 }, { "V2 zlib", &v2z }, { "V2 sparse", &v2s } };
+
+    for (Case& c : cases) {
+        MemorySource src(c.file->data(), c.file->size());
+        FseqReader reader;
+        if (!reader.open(&src)) {
+            printf("%-14s open FAILED (%s)\n", c.name, reader.lastError());
+            ok = false;
+            continue;
+        }
+        ReadStats s = timeSequentialRead(reader);
+        printRead(c.name, reader, s);
+        ok = timeLateJoin(c.name, &src) && ok && s.ok;
+        ok = benchAnalyzer(c.name, reader) && ok;
+        if (reader.info().compression == FSEQ_COMPRESSION_NONE) ok = benchRangeReads(c.name, *c.file) && ok;
+
+        if (reader.info().compression == FSEQ_COMPRESSION_ZLIB) {
+            printf("%-14s %u bytes in %u blocks (%.2f:1) | random seek avg %.2f us\n", c.name,
+                   (unsigned)c.file->size(), reader.info().blockCount, frames.size() / (double)c.file->size(),
+                   timeRandomSeek(reader));
+        } else {
+            ok = benchDelta(c.name, reader, c.file->size()) && ok;
+        }
+    }
+
+    printf("--- Flash slot playback ---\n");
+    ok = benchMappedPlayback(v1) && ok;
+
+    printf("--- Power limit ---\n");
+    ok = benchPowerScale(v1) && ok;
+
+    printf("--- File index ---\n");
+    ok = benchFileIndex(v1, v2z) && ok;
+
+    printf("--- Channel mapper ---\n");
+    benchMapping();
+    benchInterpolation();
+
+    printf("--- LED output ---\n");
+    benchLedOutput();
+
+    printf("--- Frame clock ---\n");
+    benchFrameClock();
+
+    printf("--- Clock sync ---\n");
+    benchTimeSync();
+
+    printf("--- Pipeline metrics ---\n");
+    benchMetrics();
+
+    return ok ? 0 : 1;
+}
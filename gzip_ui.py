@@ -0,0 +1,25 @@
+Import("env")
+import gzip
+import os
+
+# Compresses the web UI (web/index.html) into the LittleFS image folder.
+# The firmware serves data/index.html.gz as-is with Content-Encoding: gzip.
+def gzip_ui():
+    project_dir = env.subst("$PROJECT_DIR")
+    source = os.path.join(project_dir, "web", "index.html")
+    target = os.path.join(project_dir, "data", "index.html.gz")
+
+    with open(source, "rb") as f:
+        html = f.read()
+    # mtime=0 keeps the output (and the device-side ETag) stable between builds
+    packed = gzip.compress(html, compresslevel=9, mtime=0)
+
+    if os.path.exists(target):
+        with open(target, "rb") as f:
+            if f.read() == packed:
+                return
+    with open(target, "wb") as f:
+        f.write(packed)
+    print(f"📦 Web UI: {len(html)} -> {len(packed)} bytes (data/index.html.gz)")
+
+gzip_ui()
@@ -0,0 +1,194 @@
+/**
+ * =====================================================================
+ * myS3XY-Lightshow: leader/follower sync harness (Linux)
+ * =====================================================================
+ * One leader and several followers exchange real UDP beacons on
+ * localhost (pio run -e native_sync, then
+ * .pio/build/native_sync/program [followers] [seconds] [ppm]).
+ *
+ * Every node runs its own FrameClock on a simulated crystal: a fixed
+ * offset plus a drift of up to +-ppm. Followers start up to 150 ms off
+ * (independent countdowns), beacons see 0-8 ms of delivery delay and
+ * 5% loss. Once per second the harness prints each follower's phase
+ * error against the leader, with sync and free-running.
+ * =====================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "ClockBeacon.h"
+#include "FrameClock.h"
+
+#define HARNESS_STEP_MS   20
+#define HARNESS_START_US  500000     // True time of frame 0
+#define HARNESS_SETTLE_S  10         // Errors before this are not judged
+#define HARNESS_LIMIT_US  10000      // Synced phase error that fails the run
+
+static std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+/**
+ * True time since the harness started (us).
+ */
+static int64_t trueUs() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now() - epoch).count();
+}
+
+struct Node {
+    double ppm = 0;
+    int64_t offsetUs = 0;
+    FrameClock clock;          // Slewed by the follower
+    FrameClock freeClock;      // Same start, never corrected
+    ClockFollower follower;
+    std::mutex lock;
+    int sock = -1;
+    uint16_t port = 0;
+
+    // Local crystal time at true time 't'
+    uint64_t local(int64_t t) const { return (uint64_t)(t + (int64_t)(t * ppm / 1e6) + offsetUs); }
+    int64_t phase(FrameClock& c, int64_t t) { return c.elapsedUs(local(t)); }
+};
+
+static std::atomic<bool> running{ true };
+
+static void leaderLoop(Node& leader, std::vector<std::unique_ptr<Node>>& followers) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    ClockBeacon beacon;
+    beacon.showId = 0x5e3c0de;
+    beacon.stepTimeMs = HARNESS_STEP_MS;
+    uint8_t packet[BEACON_SIZE];
+
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(BEACON_INTERVAL_MS));
+        int64_t t = trueUs();
+        beacon.showTimeUs = leader.phase(leader.clock, t);
+        if (beacon.showTimeUs < 0) continue;
+        beacon.frame = beacon.showTimeUs / (HARNESS_STEP_MS * 1000);
+        beacon.sequence++;
+        encodeBeacon(beacon, packet);
+
+        for (auto& f : followers) {
+            sockaddr_in to = {};
+            to.sin_family = AF_INET;
+            to.sin_port = htons(f->port);
+            to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            sendto(sock, packet, sizeof(packet), 0, (sockaddr*)&to, sizeof(to));
+        }
+    }
+    close(sock);
+}
+
+static void followerLoop(Node& node, unsigned seed) {
+    std::mt19937 rng(seed);
+    uint8_t packet[64];
+    while (running) {
+        ssize_t len = recv(node.sock, packet, sizeof(packet), 0);
+        if (len <= 0) continue;   // Receive timeout: check 'running'
+
+        ClockBeacon beacon;
+        if (!decodeBeacon(packet, len, beacon)) continue;
+        if (rng() % 100 < 5) continue;                                              // Loss
+        std::this_thread::sleep_for(std::chrono::microseconds(rng() % 8000));       // Air + stack delay
+
+        std::lock_guard<std::mutex> guard(node.lock);
+        int64_t t = trueUs();
+        node.clock.shift(node.follower.onBeacon(beacon, node.phase(node.clock, t)));
+    }
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 4;
+    int seconds = argc > 2 ? atoi(argv[2]) : 30;
+    double maxPpm = argc > 3 ? atof(argv[3]) : 1000;   // Exaggerated so drift shows within seconds
+    std::mt19937 rng(42);
+
+    // A run must judge at least one second after settling, or it would pass unmeasured
+    if (count < 1 || seconds <= HARNESS_SETTLE_S) {
+        printf("ERR: need at least 1 follower and more than %d seconds (got %d, %d)\n", HARNESS_SETTLE_S, count,
+               seconds);
+        return 2;
+    }
+
+    Node leader;
+    leader.offsetUs = 10000000;
+    leader.clock.start(leader.local(HARNESS_START_US), HARNESS_STEP_MS);
+
+    std::vector<std::unique_ptr<Node>> followers;
+    for (int i = 0; i < count; i++) {
+        std::unique_ptr<Node> n(new Node());
+        n->ppm = ((int)(rng() % 2001) - 1000) * maxPpm / 1000.0;
+        n->offsetUs = 10000000 + (int64_t)(rng() % 5000000);
+        int64_t startError = (int64_t)(rng() % 300001) - 150000;
+        n->clock.start(n->local(HARNESS_START_US) + startError, HARNESS_STEP_MS);
+        n->freeClock.start(n->local(HARNESS_START_US) + startError, HARNESS_STEP_MS);
+
+        n->sock = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;   // Any free port
+        socklen_t addrLen = sizeof(addr);
+        if (n->sock < 0 || bind(n->sock, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+            getsockname(n->sock, (sockaddr*)&addr, &addrLen) != 0) {
+            printf("ERR: cannot open UDP socket for follower %d\n", i);
+            return 1;
+        }
+        n->port = ntohs(addr.sin_port);
+        timeval timeout = { 0, 100000 };
+        setsockopt(n->sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        printf("follower %d: port %u, drift %+.0f ppm, start error %+.1f ms\n", i, n->port, n->ppm,
+               startError / 1000.0);
+        followers.push_back(std::move(n));
+    }
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(leaderLoop, std::ref(leader), std::ref(followers));
+    for (int i = 0; i < count; i++) threads.emplace_back(followerLoop, std::ref(*followers[i]), 100 + i);
+
+    // --- Phase error report (ms, follower - leader) ---
+    int64_t worstSynced = 0, worstFree = 0;
+    for (int s = 1; s <= seconds; s++) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        int64_t t = trueUs();
+        int64_t leaderPhase = leader.phase(leader.clock, t);
+
+        printf("t=%3ds synced:", s);
+        std::vector<int64_t> freeErr;
+        for (auto& f : followers) {
+            std::lock_guard<std::mutex> guard(f->lock);
+            int64_t e = f->phase(f->clock, t) - leaderPhase;
+            freeErr.push_back(f->phase(f->freeClock, t) - leaderPhase);
+            printf(" %+8.2f", e / 1000.0);
+            if (s > HARNESS_SETTLE_S && llabs(e) > worstSynced) worstSynced = llabs(e);
+        }
+        printf(" | free:");
+        for (int64_t e : freeErr) {
+            printf(" %+8.2f", e / 1000.0);
+            if (s > HARNESS_SETTLE_S && llabs(e) > worstFree) worstFree = llabs(e);
+        }
+        printf("\n");
+    }
+
+    running = false;
+    for (auto& th : threads) th.join();
+    for (auto& f : followers) close(f->sock);
+
+    bool ok = worstSynced < HARNESS_LIMIT_US;
+    printf("after %d s: worst phase error synced %.2f ms, free-running %.2f ms -> %s\n", HARNESS_SETTLE_S,
+           worstSynced / 1000.0, worstFree / 1000.0, ok ? "OK" : "FAILED");
+    for (size_t i = 0; i < followers.size(); i++) {
+        printf("follower %zu: %u beacons, %u jumps\n", i, followers[i]->follower.beacons(),
+               followers[i]->follower.jumps());
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/**
+ * =====================================================================
+ * ShowEngine: byte I/O interfaces
+ * =====================================================================
+ * The reader, converter and compiler only see these two interfaces.
+ * The firmware backs them with LittleFS files (src/LittleFsSource.h),
+ * the native build with stdio files or plain memory.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+
+/**
+ * Random-access, read-only byte stream (a show file).
+ */
+class ByteSource {
+public:
+    virtual ~ByteSource() {}
+    virtual uint32_t size() = 0;
+    // Reads up to 'len' bytes at 'offset'; returns the number of bytes read
+    virtual size_t readAt(uint32_t offset, uint8_t* dst, size_t len) = 0;
+    // Whole source as one addressable block (RAM or memory-mapped flash),
+    // nullptr if it can only be read. Lets readers use frames in place.
+    virtual const uint8_t* data() { return nullptr; }
+};
+
+/**
+ * Sequential byte sink with a rewind for late header writes.
+ */
+class ByteSink {
+public:
+    virtual ~ByteSink() {}
+    virtual size_t write(const uint8_t* data, size_t len) = 0;
+    virtual bool seek(uint32_t offset) = 0;
+};
+
+/**
+ * Show held in addressable memory: RAM (tests, benchmarks, synthetic
+ * shows) or a memory-mapped flash partition.
+ */
+class MemorySource : public ByteSource {
+public:
+    MemorySource(const uint8_t* data = nullptr, uint32_t len = 0) : _data(data), _len(len) {}
+
+    void assign(const uint8_t* data, uint32_t len) {
+        _data = data;
+        _len = len;
+    }
+
+    uint32_t size() override { return _len; }
+    const uint8_t* data() override { return _data; }
+    size_t readAt(uint32_t offset, uint8_t* dst, size_t len) override {
+        if (offset >= _len) return 0;
+        if (len > _len - offset) len = _len - offset;
+        memcpy(dst, _data + offset, len);
+        return len;
+    }
+
+private:
+    const uint8_t* _data;
+    uint32_t _len;
+};
+
+/**
+ * Growable in-memory sink.
+ */
+class MemorySink : public ByteSink {
+public:
+    std::vector<uint8_t> data;
+
+    size_t write(const uint8_t* src, size_t len) override {
+        if (_pos + len > data.size()) data.resize(_pos + len);
+        memcpy(data.data() + _pos, src, len);
+        _pos += len;
+        return len;
+    }
+    bool seek(uint32_t offset) override {
+        if (offset > data.size()) return false;
+        _pos = offset;
+        return true;
+    }
+
+private:
+    size_t _pos = 0;
+};
+
+#ifndef ARDUINO
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Show file on the host file system (native build only).
+ */
+class StdioFileSource : public ByteSource {
+public:
+    ~StdioFileSource() override { close(); }
+
+    bool open(const char* path) {
+        close();
+        _file = fopen(path, "rb");
+        if (!_file) return false;
+        fseek(_file, 0, SEEK_END);
+        _size = (uint32_t)ftell(_file);
+        return true;
+    }
+    void close() {
+        if (_file) fclose(_file);
+        _file = nullptr;
+    }
+
+    uint32_t size() override { return _size; }
+    size_t readAt(uint32_t offset, uint8_t* dst, size_t len) override {
+        if (!_file || fseek(_file, offset, SEEK_SET) != 0) return 0;
+        return fread(dst, 1, len, _file);
+    }
+
+private:
+    FILE* _file = nullptr;
+    uint32_t _size = 0;
+};
+
+/**
+ * Show file mapped into memory (native build only): the host stand-in
+ * for a show played from the raw flash slot.
+ */
+class MappedFileSource : public MemorySource {
+public:
+    ~MappedFileSource() override { close(); }
+
+    bool open(const char* path) {
+        close();
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        void* p = fstat(fd, &st) == 0 && st.st_size > 0
+                      ? mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        _map = p;
+        _mapLen = st.st_size;
+        assign((const uint8_t*)p, (uint32_t)st.st_size);
+        return true;
+    }
+    void close() {
+        if (_map) munmap(_map, _mapLen);
+        _map = nullptr;
+        assign(nullptr, 0);
+    }
+
+private:
+    void* _map = nullptr;
+    size_t _mapLen = 0;
+};
+
+/**
+ * Output file on the host file system (native build only).
+ */
+class StdioFileSink : public ByteSink {
+public:
+    ~StdioFileSink() override { close(); }
+
+    bool open(const char* path) {
+        close();
+        _file = fopen(path, "wb");
+        return _file != nullptr;
+    }
+    void close() {
+        if (_file) fclose(_file);
+        _file = nullptr;
+    }
+
+    size_t write(const uint8_t* data, size_t len) override {
+        return _file ? fwrite(data, 1, len, _file) : 0;
+    }
+    bool seek(uint32_t offset) override {
+        return _file && fseek(_file, offset, SEEK_SET) == 0;
+    }
+
+private:
+    FILE* _file = nullptr;
+};
+#endif
@@ -0,0 +1,72 @@
+#include "ChannelAnalyzer.h"
+#include "FseqReader.h"
+#include "Platform.h"
+#include <stdio.h>
+#include <string.h>
+
+bool analyzeChannels(FseqReader& src, ChannelAnalysis& out) {
+    const FseqInfo& info = src.info();
+    out = ChannelAnalysis();
+    out.frames = info.frameCount;
+    out.stepTimeMs = info.stepTimeMs;
+    out.channels.assign(ANALYZER_CHANNELS, ChannelStats());
+
+    static uint8_t frame[LOGICAL_CHANNELS];
+    static uint8_t wasOn[ANALYZER_CHANNELS];
+    memset(frame, 0, sizeof(frame)); // Channels outside sparse ranges stay black
+    memset(wasOn, 0, sizeof(wasOn));
+
+    uint32_t t0 = engineMicros();
+    for (uint32_t f = 0; f < info.frameCount; f++) {
+        if (!src.readFrame(f, frame)) {
+            out.failedFrame = f;
+            return false;
+        }
+        for (uint16_t ch = 0; ch < ANALYZER_CHANNELS; ch++) {
+            uint8_t v = frame[ch];
+            ChannelStats& s = out.channels[ch];
+            if (v > s.max) s.max = v;
+            s.histogram[v >> 6]++;
+
+            uint8_t on = v > 0;
+            s.activeFrames += on;
+            s.toggles += on ^ wasOn[ch];
+            wasOn[ch] = on;
+        }
+        if ((f & 63) == 63) engineYield();
+    }
+    out.scanUs = engineMicros() - t0;
+    return true;
+}
+
+bool writeChannelReport(const ChannelAnalysis& a, const char* showName, ByteSink& out) {
+    char buf[160];
+    uint16_t silent = 0;
+    for (const ChannelStats& s : a.channels) silent += s.max == 0;
+
+    // File names go into a JSON string: drop quotes, backslashes and control characters
+    char name[64];
+    size_t len = 0;
+    for (const char* c = showName; *c && len < sizeof(name) - 1; c++) {
+        if (*c != '"' && *c != '\\' && (uint8_t)*c >= 0x20) name[len++] = *c;
+    }
+    name[len] = 0;
+
+    int n = snprintf(buf, sizeof(buf),
+                     "{\"show\":\"%s\",\"frames\":%u,\"stepMs\":%u,\"scanMs\":%u,\"silent\":%u,\"channels\":[",
+                     name, (unsigned)a.frames, (unsigned)a.stepTimeMs, (unsigned)(a.scanUs / 1000), silent);
+    bool ok = n > 0 && n < (int)sizeof(buf) && out.write((const uint8_t*)buf, n) == (size_t)n;
+
+    bool first = true;
+    for (uint16_t ch = 0; ok && ch < a.channels.size(); ch++) {
+        const ChannelStats& s = a.channels[ch];
+        if (s.max == 0) continue;
+        n = snprintf(buf, sizeof(buf), "%s{\"ch\":%u,\"max\":%u,\"active\":%u,\"toggles\":%u,\"hist\":[%u,%u,%u,%u]}",
+                     first ? "" : ",", ch, s.max, (unsigned)s.activeFrames, (unsigned)s.toggles,
+                     (unsigned)s.histogram[0], (unsigned)s.histogram[1], (unsigned)s.histogram[2],
+                     (unsigned)s.histogram[3]);
+        ok = out.write((const uint8_t*)buf, n) == (size_t)n;
+        first = false;
+    }
+    return ok && out.write((const uint8_t*)"]}", 2) == 2;
+}
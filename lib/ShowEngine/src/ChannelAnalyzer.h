@@ -0,0 +1,46 @@
+/**
+ * =====================================================================
+ * ShowEngine: offline channel analyzer
+ * =====================================================================
+ * Scans every frame of a show at storage speed (no frame clock) and
+ * collects per logical channel: peak value, frames with light, off/on
+ * toggles and a coarse value histogram. The report is JSON so the web
+ * UI can use it directly when a new show is mapped to LEDs.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "ByteSource.h"
+
+#define ANALYZER_CHANNELS 512   // Logical channels covered (Tesla layouts stay below 512)
+#define ANALYZER_BUCKETS  4     // Value histogram: 0-63 | 64-127 | 128-191 | 192-255
+
+class FseqReader;
+
+struct ChannelStats {
+  uint8_t max = 0;
+  uint32_t activeFrames = 0;    // Frames with a value above 0
+  uint32_t toggles = 0;         // Off <-> on transitions
+  uint32_t histogram[ANALYZER_BUCKETS] = { 0 };
+};
+
+struct ChannelAnalysis {
+  uint32_t frames = 0;
+  uint16_t stepTimeMs = 0;
+  uint32_t scanUs = 0;          // Time for the whole scan
+  uint32_t failedFrame = 0;     // Frame that could not be read
+  std::vector<ChannelStats> channels;
+};
+
+/**
+ * Reads every frame of an open show and fills 'out'.
+ */
+bool analyzeChannels(FseqReader& src, ChannelAnalysis& out);
+
+/**
+ * Writes the analysis as JSON. Only channels that light up are listed;
+ * "silent" counts the rest.
+ */
+bool writeChannelReport(const ChannelAnalysis& analysis, const char* showName, ByteSink& out);
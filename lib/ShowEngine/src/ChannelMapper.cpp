@@ -0,0 +1,102 @@
+#include "ChannelMapper.h"
+#include "FseqReader.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+uint8_t channelColorClass(uint16_t ch) {
+    if (ch == 139 || ch == 142 || ch == 339 || ch == 342) return COLOR_AMBER;
+    if ((ch >= 364 && ch <= 371) || ch == 392) return COLOR_RED;
+    if (ch >= 151 && ch <= 160) return COLOR_BLUE;
+    return COLOR_WHITE;
+}
+
+static ColorClass makeClass(const char* name, uint8_t r, uint8_t g, uint8_t b) {
+    ColorClass c;
+    snprintf(c.name, sizeof(c.name), "%s", name);
+    c.tint[0] = r;
+    c.tint[1] = g;
+    c.tint[2] = b;
+    return c;
+}
+
+ColorProfile defaultColorProfile() {
+    ColorProfile p;
+    p.classes.resize(COLOR_BUILTIN_COUNT);
+    p.classes[COLOR_OFF] = makeClass("off", 0, 0, 0);
+    p.classes[COLOR_OFF].max[0] = p.classes[COLOR_OFF].max[1] = p.classes[COLOR_OFF].max[2] = 0;
+    p.classes[COLOR_AMBER] = makeClass("amber", 255, 159, 0);   // (val, val*160>>8, 0)
+    p.classes[COLOR_RED] = makeClass("red", 255, 0, 0);
+    p.classes[COLOR_BLUE] = makeClass("blue", 99, 99, 255);     // (val*100>>8, val*100>>8, val)
+    p.classes[COLOR_WHITE] = makeClass("white", 255, 255, 255);
+    return p;
+}
+
+int findColorClass(const ColorProfile& profile, const char* name) {
+    for (size_t i = 0; i < profile.classes.size(); i++) {
+        if (strncmp(profile.classes[i].name, name, sizeof(profile.classes[i].name)) == 0) return (int)i;
+    }
+    return -1;
+}
+
+void buildColorLut(const ColorClass& cls, ColorLut& lut) {
+    for (uint16_t v = 0; v < 256; v++) {
+        // 1. Gamma on the value (1.0 keeps it exact)
+        uint16_t curved = v;
+        if (cls.gamma != 1.0f && cls.gamma > 0) curved = (uint16_t)lroundf(255.0f * powf(v / 255.0f, cls.gamma));
+
+        // 2. Tint and limits per component; black stays black
+        for (uint8_t c = 0; c < 3; c++) {
+            uint16_t out = (curved * (cls.tint[c] + 1)) >> 8;
+            if (v > 0 && out < cls.min[c]) out = cls.min[c];
+            if (out > cls.max[c]) out = cls.max[c];
+            lut.c[c][v] = v ? out : 0;
+        }
+    }
+}
+
+void buildColorLuts(const ColorProfile& profile, std::vector<ColorLut>& luts) {
+    luts.resize(profile.classes.size());
+    for (size_t i = 0; i < profile.classes.size(); i++) buildColorLut(profile.classes[i], luts[i]);
+}
+
+const ColorLut* defaultColorLuts() {
+    static std::vector<ColorLut> luts;
+    if (luts.empty()) buildColorLuts(defaultColorProfile(), luts);
+    return luts.data();
+}
+
+/**
+ * Class of LED 'led' on channel 'ch': the last matching LED rule, else the
+ * last matching channel rule, else the built-in class.
+ */
+static uint8_t resolveColorClass(const ColorProfile* profile, uint16_t led, uint16_t ch) {
+    if (!profile) return channelColorClass(ch);
+    int byChannel = -1;
+    int byLed = -1;
+    for (const ColorRule& r : profile->rules) {
+        if (r.colorClass >= profile->classes.size()) continue;
+        uint16_t key = r.byLed ? led : ch;
+        if (key < r.first || key > r.last) continue;
+        if (r.byLed) byLed = r.colorClass;
+        else byChannel = r.colorClass;
+    }
+    if (byLed >= 0) return byLed;
+    if (byChannel >= 0) return byChannel;
+    return channelColorClass(ch);
+}
+
+void compileLedMap(const std::vector<LedMapping>& mapping, LedMapTable& map, bool ledOrder,
+                   const ColorProfile* profile) {
+    for (uint16_t i = 0; i < map.count; i++) {
+        uint16_t ch = mapping[i].channel;
+        if (ch >= LOGICAL_CHANNELS) {
+            // 9999 (dead LED) or beyond the logical frame: always black
+            map.src[i] = 0;
+            map.color[i] = COLOR_OFF;
+            continue;
+        }
+        map.src[i] = ledOrder ? i : ch;
+        map.color[i] = resolveColorClass(profile, i, ch);
+    }
+}
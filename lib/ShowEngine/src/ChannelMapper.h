@@ -0,0 +1,151 @@
+/**
+ * =====================================================================
+ * ShowEngine: channel mapper
+ * =====================================================================
+ * Turns a logical channel frame into LED colors through a compiled map
+ * table, so the per-frame work is a branch-free gather-and-lookup loop.
+ * Colors come from classes (tint, gamma, limits) that are precomputed
+ * into 256-entry tables per component when the config loads.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+struct LedMapping {
+  uint16_t channel;
+};
+
+// --- Color classes ---
+// Built-in classes (PRECISION COLOR LOGIC V1.0.0); config classes follow.
+enum ColorClassId : uint8_t {
+  COLOR_OFF,      // Dead or out-of-range LEDs: always black
+  COLOR_AMBER,    // Indicators
+  COLOR_RED,      // Brake/Rear
+  COLOR_BLUE,     // Matrix
+  COLOR_WHITE,    // Main Beams/Reverse and everything else
+  COLOR_BUILTIN_COUNT
+};
+
+#define MAX_COLOR_CLASSES 16     // 768 bytes of tables each
+
+/**
+ * A color curve: out = tint * (val/255)^gamma per component, then held
+ * within min..max. A value of 0 stays black.
+ */
+struct ColorClass {
+  char name[16] = { 0 };
+  uint8_t tint[3] = { 255, 255, 255 };
+  float gamma = 1.0f;
+  uint8_t min[3] = { 0, 0, 0 };
+  uint8_t max[3] = { 255, 255, 255 };
+};
+
+/**
+ * Puts a channel range or an LED range into a class. LED rules win over
+ * channel rules, later rules over earlier ones.
+ */
+struct ColorRule {
+  uint8_t colorClass;
+  bool byLed;             // first/last are LED indices, else channels
+  uint16_t first;
+  uint16_t last;
+};
+
+struct ColorProfile {
+  std::vector<ColorClass> classes;   // Indexed by class id, built-ins first
+  std::vector<ColorRule> rules;
+};
+
+/**
+ * One lookup table per color component, built by buildColorLut().
+ */
+struct ColorLut {
+  uint8_t c[3][256];
+};
+
+/**
+ * Compiled LED map (structure of arrays), built by compileLedMap().
+ * Each LED reads one logical channel and looks its color up in the
+ * table of its class: out.r = luts[color].c[0][val].
+ */
+struct LedMapTable {
+  uint16_t* src;          // Logical channel index per LED
+  uint8_t*  color;        // Color class per LED
+  const ColorLut* luts;   // One per class of the profile
+  uint16_t  count;
+};
+
+/**
+ * Built-in class of a Tesla channel: amber indicators, red rear lights,
+ * blue matrix, white for everything else.
+ */
+uint8_t channelColorClass(uint16_t ch);
+
+/**
+ * The built-in classes alone (with gamma 1 they reproduce the former
+ * multiply-shift scales exactly).
+ */
+ColorProfile defaultColorProfile();
+
+/**
+ * Finds a class by name (-1 if unknown).
+ */
+int findColorClass(const ColorProfile& profile, const char* name);
+
+/**
+ * Precomputes the three component tables of a class.
+ */
+void buildColorLut(const ColorClass& cls, ColorLut& lut);
+
+/**
+ * Tables for every class of 'profile', indexed by class id.
+ */
+void buildColorLuts(const ColorProfile& profile, std::vector<ColorLut>& luts);
+
+/**
+ * Tables of defaultColorProfile(), built on first use.
+ */
+const ColorLut* defaultColorLuts();
+
+/**
+ * Compiles a list of LED channels into a map table (map.count entries).
+ * ledOrder: frames come from a compiled show sidecar, where byte i already
+ * holds the value of LED i, so only the color class depends on the channel.
+ * Without a profile every LED gets its built-in class.
+ */
+void compileLedMap(const std::vector<LedMapping>& mapping, LedMapTable& map, bool ledOrder = false,
+                   const ColorProfile* profile = nullptr);
+
+/**
+ * Gather-and-lookup kernel: logical frame -> LED colors via the compiled map.
+ * Pixel is anything with r/g/b byte members (CRGB on the device).
+ */
+template <typename Pixel>
+void mapFrameToLeds(const uint8_t* frame, const LedMapTable& map, Pixel* out) {
+    for (uint16_t i = 0; i < map.count; i++) {
+        uint8_t val = frame[map.src[i]];
+        const ColorLut& lut = map.luts[map.color[i]];
+        out[i].r = lut.c[0][val];
+        out[i].g = lut.c[1][val];
+        out[i].b = lut.c[2][val];
+    }
+}
+
+/**
+ * Interpolation kernel: mapFrameToLeds() on a blend of two frames.
+ * weight is fixed point 0..256 (0 = 'from', 256 = 'to'); one multiply-add
+ * per LED on top of the lookup, no allocation.
+ */
+template <typename Pixel>
+void blendFrameToLeds(const uint8_t* from, const uint8_t* to, uint16_t weight, const LedMapTable& map, Pixel* out) {
+    uint16_t keep = 256 - weight;
+    for (uint16_t i = 0; i < map.count; i++) {
+        uint8_t val = (from[map.src[i]] * keep + to[map.src[i]] * weight) >> 8;
+        const ColorLut& lut = map.luts[map.color[i]];
+        out[i].r = lut.c[0][val];
+        out[i].g = lut.c[1][val];
+        out[i].b = lut.c[2][val];
+    }
+}
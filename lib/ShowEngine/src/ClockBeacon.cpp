@@ -0,0 +1,69 @@
+#include "ClockBeacon.h"
+#include <string.h>
+
+static void putLe(uint8_t* p, uint64_t v, uint8_t bytes) {
+    for (uint8_t i = 0; i < bytes; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint64_t getLe(const uint8_t* p, uint8_t bytes) {
+    uint64_t v = 0;
+    for (uint8_t i = 0; i < bytes; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+void encodeBeacon(const ClockBeacon& beacon, uint8_t* out) {
+    memcpy(out, BEACON_MAGIC, 4);
+    putLe(out + 4, beacon.showId, 4);
+    putLe(out + 8, beacon.frame, 4);
+    putLe(out + 12, (uint64_t)beacon.showTimeUs, 8);
+    putLe(out + 20, beacon.stepTimeMs, 2);
+    putLe(out + 22, beacon.sequence, 2);
+}
+
+bool decodeBeacon(const uint8_t* data, size_t len, ClockBeacon& beacon) {
+    if (len < BEACON_SIZE || memcmp(data, BEACON_MAGIC, 4) != 0) return false;
+    beacon.showId = (uint32_t)getLe(data + 4, 4);
+    beacon.frame = (uint32_t)getLe(data + 8, 4);
+    beacon.showTimeUs = (int64_t)getLe(data + 12, 8);
+    beacon.stepTimeMs = (uint16_t)getLe(data + 20, 2);
+    beacon.sequence = (uint16_t)getLe(data + 22, 2);
+    return true;
+}
+
+void ClockFollower::reset() {
+    _count = 0;
+    _pos = 0;
+    _phaseUs = 0;
+    _beacons = 0;
+    _jumps = 0;
+}
+
+int64_t ClockFollower::onBeacon(const ClockBeacon& beacon, int64_t localShowUs) {
+    _beacons++;
+
+    // 1. Minimum filter over the last beacons (delay only adds)
+    _window[_pos] = localShowUs - beacon.showTimeUs;
+    _pos = (_pos + 1) % FOLLOWER_WINDOW;
+    if (_count < FOLLOWER_WINDOW) _count++;
+
+    int64_t phase = _window[0];
+    for (uint8_t i = 1; i < _count; i++) {
+        if (_window[i] < phase) phase = _window[i];
+    }
+    _phaseUs = phase;
+
+    // 2. Far off (e.g. a missed countdown): align at once and start over
+    if (phase > FOLLOWER_JUMP_US || phase < -FOLLOWER_JUMP_US) {
+        _count = 0;
+        _pos = 0;
+        _jumps++;
+        return phase;
+    }
+
+    // 3. Slew: capped correction, the window follows the shifted clock
+    int64_t shift = phase;
+    if (shift > FOLLOWER_MAX_SLEW_US) shift = FOLLOWER_MAX_SLEW_US;
+    if (shift < -FOLLOWER_MAX_SLEW_US) shift = -FOLLOWER_MAX_SLEW_US;
+    for (uint8_t i = 0; i < _count; i++) _window[i] -= shift;
+    return shift;
+}
@@ -0,0 +1,73 @@
+/**
+ * =====================================================================
+ * ShowEngine: leader/follower frame clock sync
+ * =====================================================================
+ * The leader broadcasts a beacon every BEACON_INTERVAL_MS while a show
+ * runs. Followers compare the leader's show time with their own at
+ * reception and slew their frame clock toward it.
+ *
+ * Beacon (24 bytes, little endian):
+ *   0 "LSB1" | 4 show id | 8 frame index | 12 leader show time (us, 64-bit)
+ *   20 step time (ms) | 22 sequence
+ *
+ * Network delay only ever makes a beacon look older, so the smallest
+ * (local - leader) difference over the last FOLLOWER_WINDOW beacons is
+ * the best phase estimate. Corrections are capped per beacon (a slight
+ * tempo change instead of a visible jump); only errors beyond
+ * FOLLOWER_JUMP_US are applied at once.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define BEACON_MAGIC         "LSB1"
+#define BEACON_SIZE          24
+#define BEACON_PORT          4210
+#define BEACON_INTERVAL_MS   250
+#define FOLLOWER_WINDOW      8        // Beacons in the minimum filter (2 s)
+#define FOLLOWER_MAX_SLEW_US 5000     // Largest correction per beacon (2% tempo at 4 Hz)
+#define FOLLOWER_JUMP_US     500000   // Phase errors beyond this are applied at once
+
+struct ClockBeacon {
+  uint32_t showId = 0;
+  uint32_t frame = 0;
+  int64_t showTimeUs = 0;   // Leader time since frame 0 was due
+  uint16_t stepTimeMs = 0;
+  uint16_t sequence = 0;
+};
+
+/**
+ * Writes BEACON_SIZE bytes to 'out'.
+ */
+void encodeBeacon(const ClockBeacon& beacon, uint8_t* out);
+
+/**
+ * False if the packet is not a beacon.
+ */
+bool decodeBeacon(const uint8_t* data, size_t len, ClockBeacon& beacon);
+
+class ClockFollower {
+public:
+    void reset();
+
+    /**
+     * Feeds a beacon received at 'localShowUs' (own time since frame 0
+     * was due). Returns the shift for the frame clock start in us
+     * (positive: this node is ahead and waits).
+     */
+    int64_t onBeacon(const ClockBeacon& beacon, int64_t localShowUs);
+
+    int64_t phaseErrorUs() const { return _phaseUs; }   // Filtered, before the last correction
+    uint32_t beacons() const { return _beacons; }
+    uint32_t jumps() const { return _jumps; }
+
+private:
+    int64_t _window[FOLLOWER_WINDOW];
+    uint8_t _count = 0;
+    uint8_t _pos = 0;
+    int64_t _phaseUs = 0;
+    uint32_t _beacons = 0;
+    uint32_t _jumps = 0;
+};
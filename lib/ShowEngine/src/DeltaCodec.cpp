@@ -0,0 +1,140 @@
+#include "DeltaCodec.h"
+#include "FseqReader.h"
+#include "Platform.h"
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+bool applyDeltaRecord(uint8_t* frame, uint16_t n, const uint8_t* rec, size_t len) {
+    uint16_t pos = 0;
+    size_t i = 0;
+    while (i < len) {
+        uint8_t c = rec[i++];
+        uint16_t run = (c < 0x80) ? c + 1 : (c & 0x3F) + 1;
+        if (pos + run > n) return false;
+
+        if (c >= 0xC0) {
+            if (i >= len) return false;
+            memset(frame + pos, rec[i++], run);
+        } else if (c >= 0x80) {
+            if (i + run > len) return false;
+            memcpy(frame + pos, rec + i, run);
+            i += run;
+        }
+        pos += run;
+    }
+    return true;
+}
+
+size_t encodeDeltaRecord(const uint8_t* prev, const uint8_t* cur, uint16_t n, uint8_t* out) {
+    size_t o = 0;
+    uint16_t pos = 0;
+    while (pos < n) {
+        // 1. Unchanged run (trailing unchanged channels are implicit)
+        uint16_t same = 0;
+        while (pos + same < n && cur[pos + same] == prev[pos + same]) same++;
+        if (pos + same == n) break;
+        if (same > 0) {
+            pos += same;
+            while (same > 0) {
+                uint16_t k = std::min(same, (uint16_t)128);
+                out[o++] = k - 1;
+                same -= k;
+            }
+            continue;
+        }
+
+        // 2. Fill run of one value (fades, all-on, all-off)
+        uint16_t fill = 1;
+        while (pos + fill < n && fill < 64 && cur[pos + fill] == cur[pos]) fill++;
+        if (fill >= 3) {
+            out[o++] = 0xC0 | (fill - 1);
+            out[o++] = cur[pos];
+            pos += fill;
+            continue;
+        }
+
+        // 3. Literal run until a skip or fill token becomes cheaper
+        uint16_t lit = 1;
+        while (pos + lit < n && lit < 64) {
+            uint16_t p = pos + lit;
+            if (cur[p] == prev[p] && (p + 1 == n || cur[p + 1] == prev[p + 1])) break;
+            if (p + 2 < n && cur[p] == cur[p + 1] && cur[p] == cur[p + 2]) break;
+            lit++;
+        }
+        out[o++] = 0x80 | (lit - 1);
+        memcpy(out + o, cur + pos, lit);
+        o += lit;
+        pos += lit;
+    }
+    return o;
+}
+
+bool encodeDeltaShow(FseqReader& src, ByteSink& out, DeltaStats& stats) {
+    const FseqInfo& info = src.info();
+    uint16_t n = info.channelCount;
+    stats = DeltaStats();
+
+    static uint8_t cur[LOGICAL_CHANNELS], prev[LOGICAL_CHANNELS], check[LOGICAL_CHANNELS];
+    static uint8_t rec[2 * LOGICAL_CHANNELS + 8];
+    memset(cur, 0, sizeof(cur)); // Channels outside sparse ranges stay black
+
+    std::vector<uint32_t> keyIndex;
+    uint32_t offset = DELTA_HEADER_SIZE;
+
+    uint8_t blank[DELTA_HEADER_SIZE] = { 0 }; // Final header is written at the end
+    bool ok = out.write(blank, DELTA_HEADER_SIZE) == DELTA_HEADER_SIZE;
+
+    for (uint32_t f = 0; ok && f < info.frameCount; f++) {
+        stats.failedFrame = f;
+        if (!src.readFrame(f, cur)) { ok = false; break; }
+
+        bool keyframe = (f % DELTA_KEY_INTERVAL) == 0;
+        if (keyframe) {
+            keyIndex.push_back(offset);
+            memset(prev, 0, n);
+        }
+        size_t len = encodeDeltaRecord(prev, cur, n, rec);
+
+        // Verify with the playback decoder and time it
+        uint32_t d0 = engineMicros();
+        if (keyframe) memset(check, 0, n);
+        bool decoded = applyDeltaRecord(check, n, rec, len);
+        uint32_t dt = engineMicros() - d0;
+        stats.decodeTotalUs += dt;
+        stats.decodeMaxUs = std::max(stats.decodeMaxUs, dt);
+        if (!decoded || memcmp(check, cur, n) != 0) { ok = false; break; }
+
+        uint8_t lenBuf[2] = { (uint8_t)(len & 0xFF), (uint8_t)(len >> 8) };
+        ok = out.write(lenBuf, 2) == 2 && out.write(rec, len) == len;
+        offset += 2 + len;
+        stats.maxRecord = std::max(stats.maxRecord, (uint16_t)len);
+        memcpy(prev, cur, n);
+
+        if ((f & 63) == 0) engineYield();
+    }
+
+    if (ok) {
+        uint32_t keyCount = keyIndex.size();
+        ok = out.write((const uint8_t*)keyIndex.data(), keyCount * 4) == keyCount * 4;
+
+        uint32_t frameCount = info.frameCount;
+        uint16_t stepTimeMs = info.stepTimeMs;
+        uint8_t h[DELTA_HEADER_SIZE] = { 0 };
+        memcpy(h, DELTA_MAGIC, 4);
+        h[4] = DELTA_HEADER_SIZE;
+        h[6] = n & 0xFF;                    h[7] = n >> 8;
+        h[8] = frameCount & 0xFF;           h[9] = (frameCount >> 8) & 0xFF;
+        h[10] = (frameCount >> 16) & 0xFF;  h[11] = frameCount >> 24;
+        h[12] = stepTimeMs & 0xFF;          h[13] = stepTimeMs >> 8;
+        h[14] = DELTA_KEY_INTERVAL & 0xFF;  h[15] = DELTA_KEY_INTERVAL >> 8;
+        memcpy(h + 16, &offset, 4);         // Key index follows the last record
+        memcpy(h + 20, &keyCount, 4);
+        h[24] = stats.maxRecord & 0xFF;     h[25] = stats.maxRecord >> 8;
+        ok = ok && out.seek(0) && out.write(h, DELTA_HEADER_SIZE) == DELTA_HEADER_SIZE;
+
+        stats.frames = frameCount;
+        stats.bytesOut = offset + keyCount * 4;
+    }
+    return ok;
+}
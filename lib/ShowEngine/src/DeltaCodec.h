@@ -0,0 +1,58 @@
+/**
+ * =====================================================================
+ * ShowEngine: native delta/RLE show codec (.lsq)
+ * =====================================================================
+ * Header (32 bytes, little endian):
+ *   0 "LSD1" | 4 header size | 6 channels per frame | 8 frame count
+ *   12 step time (ms) | 14 keyframe interval | 16 key index offset
+ *   20 keyframe count | 24 largest record
+ * Records follow back to back, then the keyframe index (uint32 offsets).
+ *
+ * Record = uint16 length + tokens, applied to the previous frame
+ * (keyframes start from all-black):
+ *   0x00-0x7F  skip n+1 unchanged channels
+ *   0x80-0xBF  n+1 literal bytes follow
+ *   0xC0-0xFF  fill n+1 channels with the next byte
+ * Channels after the last token are unchanged.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ByteSource.h"
+
+#define DELTA_MAGIC        "LSD1"
+#define DELTA_HEADER_SIZE  32
+#define DELTA_KEY_INTERVAL 64     // Keyframe every N frames: a seek decodes at most N-1 deltas
+
+class FseqReader;
+
+/**
+ * Result of one show conversion.
+ */
+struct DeltaStats {
+  uint32_t frames = 0;
+  uint32_t bytesOut = 0;
+  uint16_t maxRecord = 0;
+  uint32_t decodeTotalUs = 0;    // Verification decode time over all frames
+  uint32_t decodeMaxUs = 0;
+  uint32_t failedFrame = 0;      // Frame that failed to read or verify
+};
+
+/**
+ * Applies one delta record to a frame. Returns false on a corrupt record.
+ */
+bool applyDeltaRecord(uint8_t* frame, uint16_t n, const uint8_t* rec, size_t len);
+
+/**
+ * Encodes 'cur' as a delta against 'prev' (all-black for keyframes).
+ * 'out' must hold 2 * n + 8 bytes; returns the record length.
+ */
+size_t encodeDeltaRecord(const uint8_t* prev, const uint8_t* cur, uint16_t n, uint8_t* out);
+
+/**
+ * Encodes every frame of an open show into 'out' as an .lsq stream.
+ * Each record is decoded again and compared before it is written.
+ */
+bool encodeDeltaShow(FseqReader& src, ByteSink& out, DeltaStats& stats);
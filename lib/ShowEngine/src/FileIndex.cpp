@@ -0,0 +1,114 @@
+#include "FileIndex.h"
+#include "FseqReader.h"
+#include <string.h>
+#include <algorithm>
+
+static void putLe(uint8_t* p, uint32_t v, uint8_t bytes) {
+    for (uint8_t i = 0; i < bytes; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t getLe(const uint8_t* p, uint8_t bytes) {
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < bytes; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static bool endsWith(const char* s, const char* suffix) {
+    size_t a = strlen(s), b = strlen(suffix);
+    return a >= b && strcmp(s + a - b, suffix) == 0;
+}
+
+uint8_t fileKindOf(const char* name) {
+    if (*name == '/') name++;
+    if (endsWith(name, ".fseq") || endsWith(name, ".lsq")) return FILE_KIND_SHOW;
+    if (strncmp(name, "config_", 7) == 0 && endsWith(name, ".json")) return FILE_KIND_CONFIG;
+    if (endsWith(name, ".lsc") || endsWith(name, ".lsp")) return FILE_KIND_SIDECAR;
+    if (endsWith(name, ".lsa")) return FILE_KIND_REPORT;
+    return FILE_KIND_OTHER;
+}
+
+void describeShow(FileRecord& record, const FseqInfo& info) {
+    record.version = info.version;
+    record.compression = info.compression;
+    record.frames = info.frameCount;
+    record.channels = info.channelCount;
+    record.stepTimeMs = info.stepTimeMs;
+}
+
+const FileRecord* FileIndex::find(const char* name) const {
+    if (*name == '/') name++;
+    auto it = std::lower_bound(_records.begin(), _records.end(), name,
+                               [](const FileRecord& r, const char* n) { return strcmp(r.name, n) < 0; });
+    return it != _records.end() && strcmp(it->name, name) == 0 ? &*it : nullptr;
+}
+
+void FileIndex::put(const FileRecord& record) {
+    auto it = std::lower_bound(_records.begin(), _records.end(), record,
+                               [](const FileRecord& a, const FileRecord& b) { return strcmp(a.name, b.name) < 0; });
+    if (it != _records.end() && strcmp(it->name, record.name) == 0) *it = record;
+    else _records.insert(it, record);
+}
+
+bool FileIndex::remove(const char* name) {
+    const FileRecord* r = find(name);
+    if (!r) return false;
+    _records.erase(_records.begin() + (r - _records.data()));
+    return true;
+}
+
+bool FileIndex::save(ByteSink& out) const {
+    uint8_t h[FILE_INDEX_HEADER] = { 0 };
+    memcpy(h, FILE_INDEX_MAGIC, 4);
+    putLe(h + 4, _records.size(), 4);
+    putLe(h + 8, FILE_INDEX_RECORD, 2);
+    bool ok = out.write(h, sizeof(h)) == sizeof(h);
+
+    for (const FileRecord& r : _records) {
+        uint8_t b[FILE_INDEX_RECORD] = { 0 };
+        memcpy(b, r.name, FILE_INDEX_NAME - 1);
+        putLe(b + 32, r.size, 4);
+        b[36] = r.kind;
+        b[37] = r.version;
+        b[38] = r.compression;
+        putLe(b + 40, r.frames, 4);
+        putLe(b + 44, r.channels, 4);
+        putLe(b + 48, r.stepTimeMs, 2);
+        putLe(b + 50, r.leds, 2);
+        memcpy(b + 52, r.label, FILE_INDEX_LABEL - 1);
+        ok = ok && out.write(b, sizeof(b)) == sizeof(b);
+    }
+    return ok;
+}
+
+bool FileIndex::load(ByteSource& src) {
+    _records.clear();
+    uint8_t h[FILE_INDEX_HEADER];
+    if (src.readAt(0, h, sizeof(h)) != sizeof(h) || memcmp(h, FILE_INDEX_MAGIC, 4) != 0) return false;
+    uint32_t count = getLe(h + 4, 4);
+    if (getLe(h + 8, 2) != FILE_INDEX_RECORD || src.size() != FILE_INDEX_HEADER + count * FILE_INDEX_RECORD) {
+        return false;
+    }
+
+    // One read for the whole record set
+    std::vector<uint8_t> data(count * FILE_INDEX_RECORD);
+    if (src.readAt(FILE_INDEX_HEADER, data.data(), data.size()) != data.size()) return false;
+
+    _records.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* b = data.data() + i * FILE_INDEX_RECORD;
+        FileRecord& r = _records[i];
+        memcpy(r.name, b, FILE_INDEX_NAME - 1);
+        r.size = getLe(b + 32, 4);
+        r.kind = b[36];
+        r.version = b[37];
+        r.compression = b[38];
+        r.frames = getLe(b + 40, 4);
+        r.channels = getLe(b + 44, 4);
+        r.stepTimeMs = getLe(b + 48, 2);
+        r.leds = getLe(b + 50, 2);
+        memcpy(r.label, b + 52, FILE_INDEX_LABEL - 1);
+    }
+    std::sort(_records.begin(), _records.end(),
+              [](const FileRecord& a, const FileRecord& b) { return strcmp(a.name, b.name) < 0; });
+    return true;
+}
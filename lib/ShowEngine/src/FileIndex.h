@@ -0,0 +1,90 @@
+/**
+ * =====================================================================
+ * ShowEngine: persistent file metadata index
+ * =====================================================================
+ * One record per stored file with its size, kind and what the UI and
+ * the boot path need to know about it: the parsed header of a show or
+ * the summary of a config. It is kept in RAM, updated per uploaded or
+ * deleted file and saved as one small file, so nobody has to walk the
+ * file system or open every file to list them.
+ *
+ * File (little endian): 16-byte header
+ *   0 "LSI1" | 4 record count | 8 record size | 10 reserved
+ * followed by fixed-size records (FILE_INDEX_RECORD bytes):
+ *   0 name (32, zero padded) | 32 size | 36 kind | 37 FSEQ version
+ *   38 compression | 39 reserved | 40 frames | 44 channels
+ *   48 step time (ms) | 50 LED count | 52 config name (24)
+ *   76 reserved
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "ByteSource.h"
+
+#define FILE_INDEX_MAGIC  "LSI1"
+#define FILE_INDEX_HEADER 16
+#define FILE_INDEX_RECORD 80
+#define FILE_INDEX_NAME   32     // LittleFS names are at most 31 characters
+#define FILE_INDEX_LABEL  24
+
+enum FileKind : uint8_t {
+  FILE_KIND_OTHER = 0,
+  FILE_KIND_SHOW,        // .fseq / .lsq
+  FILE_KIND_CONFIG,      // config_*.json
+  FILE_KIND_SIDECAR,     // .lsc / .lsp
+  FILE_KIND_REPORT       // .lsa
+};
+
+struct FseqInfo;
+
+struct FileRecord {
+  char name[FILE_INDEX_NAME] = { 0 };   // Without leading slash
+  uint32_t size = 0;
+  uint8_t kind = FILE_KIND_OTHER;
+  // Shows
+  uint8_t version = 0;
+  uint8_t compression = 0;
+  uint32_t frames = 0;
+  uint32_t channels = 0;
+  uint16_t stepTimeMs = 0;
+  // Configs
+  uint16_t leds = 0;
+  char label[FILE_INDEX_LABEL] = { 0 };
+
+  uint32_t durationMs() const { return frames * stepTimeMs; }
+};
+
+/**
+ * Kind of a file by its name (with or without leading slash).
+ */
+uint8_t fileKindOf(const char* name);
+
+/**
+ * Copies the header facts of an open show into its record.
+ */
+void describeShow(FileRecord& record, const FseqInfo& info);
+
+class FileIndex {
+public:
+    const std::vector<FileRecord>& records() const { return _records; }
+    const FileRecord* find(const char* name) const;
+
+    /**
+     * Adds or replaces the record of that name (kept sorted by name).
+     */
+    void put(const FileRecord& record);
+    bool remove(const char* name);
+    void clear() { _records.clear(); }
+
+    bool save(ByteSink& out) const;
+
+    /**
+     * False (and empty) if the data is not a complete index.
+     */
+    bool load(ByteSource& src);
+
+private:
+    std::vector<FileRecord> _records;
+};
@@ -0,0 +1,47 @@
+#include "FrameClock.h"
+
+static const uint32_t bucketLimits[FRAME_CLOCK_BUCKETS] = { 250, 500, 1000, 2000, 5000, 10000, 20000, 0 };
+
+uint32_t FrameClock::bucketLimitUs(uint8_t bucket) {
+    return bucket < FRAME_CLOCK_BUCKETS ? bucketLimits[bucket] : 0;
+}
+
+void FrameClock::start(uint64_t nowUs, uint16_t stepTimeMs, uint32_t firstFrame) {
+    _startUs = nowUs;
+    _stepUs = (stepTimeMs ? stepTimeMs : 50) * 1000UL;
+    reset();
+    _current = firstFrame;
+}
+
+void FrameClock::reset() {
+    _current = 0;
+    _skipped = 0;
+    resetStats();
+}
+
+void FrameClock::resetStats() {
+    for (uint8_t i = 0; i < FRAME_CLOCK_BUCKETS; i++) _lateness[i] = 0;
+    _maxLateUs = 0;
+    _totalLateUs = 0;
+    _released = 0;
+}
+
+bool FrameClock::poll(uint64_t nowUs) {
+    if (nowUs < deadline(_current)) return false;
+
+    uint32_t targetFrame = (nowUs - _startUs) / _stepUs;
+    if (targetFrame > _current + FRAME_CLOCK_MAX_LAG) {
+        _skipped += targetFrame - _current;
+        _current = targetFrame;
+    }
+
+    // Lateness of this release against its own deadline
+    uint32_t late = nowUs - deadline(_current);
+    uint8_t b = 0;
+    while (b < FRAME_CLOCK_BUCKETS - 1 && late >= bucketLimits[b]) b++;
+    _lateness[b]++;
+    if (late > _maxLateUs) _maxLateUs = late;
+    _totalLateUs += late;
+    _released++;
+    return true;
+}
@@ -0,0 +1,87 @@
+/**
+ * =====================================================================
+ * ShowEngine: frame clock
+ * =====================================================================
+ * Releases frames at absolute deadlines: frame N is due at
+ * start + N * step (microseconds, 64-bit). Deadlines are never derived
+ * from the previous release, so late frames do not shift later ones and
+ * long shows stay phase-locked to the audio and the other cars.
+ * Time is passed in by the caller, so the native build can drive it with
+ * a simulated clock.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define FRAME_CLOCK_MAX_LAG 2   // Frames behind before the clock jumps ahead
+#define FRAME_CLOCK_BUCKETS 8   // Lateness histogram: <250us ... >=20ms
+
+class FrameClock {
+public:
+    /**
+     * Starts frame 0 at 'nowUs'. A late join passes the frame to begin
+     * with: frames before it are neither played nor counted as skipped.
+     */
+    void start(uint64_t nowUs, uint16_t stepTimeMs, uint32_t firstFrame = 0);
+
+    /**
+     * True when current() is due at 'nowUs'; records its lateness.
+     * Automatic lag compensation: more than FRAME_CLOCK_MAX_LAG frames
+     * behind jumps to the due frame.
+     */
+    bool poll(uint64_t nowUs);
+
+    /**
+     * Microseconds until current() is due (<= 0: due now).
+     */
+    int64_t untilDue(uint64_t nowUs) const { return (int64_t)(deadline(_current) - nowUs); }
+    uint64_t deadline(uint32_t frame) const { return _startUs + (uint64_t)frame * _stepUs; }
+
+    /**
+     * Interpolation: output tick 'sub' of 'subs' evenly spaced ticks
+     * within the step of 'frame' (tick 0 is the frame deadline itself).
+     */
+    uint64_t tickDeadline(uint32_t frame, uint8_t sub, uint8_t subs) const {
+        return deadline(frame) + (uint64_t)_stepUs * sub / subs;
+    }
+
+    /**
+     * Time since frame 0 was due (negative before the start).
+     */
+    int64_t elapsedUs(uint64_t nowUs) const { return (int64_t)(nowUs - _startUs); }
+
+    /**
+     * Moves all deadlines by 'deltaUs' (positive: later). Used by the
+     * leader/follower sync to slew toward the leader.
+     */
+    void shift(int64_t deltaUs) { _startUs += deltaUs; }
+
+    /**
+     * Marks current() as played.
+     */
+    void advance() { _current++; }
+    void reset();
+    void resetStats();
+
+    uint32_t current() const { return _current; }
+    uint32_t skipped() const { return _skipped; }   // Frames dropped by lag compensation
+    uint16_t stepTimeMs() const { return _stepUs / 1000; }
+
+    // --- Lateness statistics (release time - deadline) ---
+    const uint32_t* lateness() const { return _lateness; }
+    uint32_t maxLateUs() const { return _maxLateUs; }
+    uint32_t avgLateUs() const { return _released ? _totalLateUs / _released : 0; }
+    static uint32_t bucketLimitUs(uint8_t bucket);   // Upper bound of a bucket (0 = open)
+
+private:
+    uint64_t _startUs = 0;
+    uint32_t _stepUs = 50000;
+    uint32_t _current = 0;
+    uint32_t _skipped = 0;
+
+    uint32_t _lateness[FRAME_CLOCK_BUCKETS] = { 0 };
+    uint32_t _maxLateUs = 0;
+    uint64_t _totalLateUs = 0;
+    uint32_t _released = 0;
+};
@@ -0,0 +1,22 @@
+#include "FrameRing.h"
+#include <string.h>
+
+uint32_t readerNextFrame(uint8_t readerSegment, uint8_t renderSegment, uint32_t nextFrame, uint32_t wanted,
+                         uint32_t frameCount) {
+    int8_t renderAhead = segmentsAhead(renderSegment, readerSegment);
+    if (renderAhead > 0) return frameCount;
+    if (renderAhead == 0 && wanted > nextFrame) return wanted;
+    return nextFrame;
+}
+
+void claimSlot(FrameSlot& slot, uint8_t segment) {
+    if (slot.segment != segment) memset(slot.data, 0, sizeof(slot.data));
+    slot.segment = segment;
+}
+
+SlotAction judgeSlot(const FrameSlot& slot, uint8_t renderSegment, uint32_t frameIdx) {
+    int8_t showAhead = segmentsAhead(slot.segment, renderSegment);
+    if (showAhead > 0) return SLOT_MISSING;
+    if (showAhead < 0 || slot.frameIdx < frameIdx) return SLOT_DROP;
+    return SLOT_PLAY;
+}
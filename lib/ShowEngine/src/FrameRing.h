@@ -0,0 +1,62 @@
+/**
+ * =====================================================================
+ * ShowEngine: frame prefetch ring handshake
+ * =====================================================================
+ * The reader task fills a ring of logical frames ahead of the frame
+ * clock, the render path plays them. A playlist runs both through a
+ * sequence of shows (segments, counted modulo 256): the reader goes on
+ * with the next show as soon as it has read the current one to the end,
+ * so the first frames of the next show are in the ring at the boundary.
+ * The reader may thus be one show ahead of the render path, and the
+ * render path (running late) ahead of the reader.
+ *
+ * Both sides decide here, so the native tests can run the handshake
+ * across a show switch without tasks.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include "FseqReader.h"
+
+/**
+ * One pre-read frame in logical channel layout.
+ */
+struct FrameSlot {
+  uint32_t frameIdx;
+  uint8_t  segment;   // Show the frame belongs to
+  uint8_t  data[LOGICAL_CHANNELS];
+};
+
+enum SlotAction : uint8_t {
+  SLOT_PLAY,      // The wanted frame
+  SLOT_DROP,      // Earlier frame or show (lag compensation, show switch)
+  SLOT_MISSING    // Already the next show: the wanted frame was never read
+};
+
+/**
+ * Shows 'a' is ahead of 'b' (negative: behind), across the wrap.
+ */
+inline int8_t segmentsAhead(uint8_t a, uint8_t b) { return (int8_t)(a - b); }
+
+/**
+ * Reader: frame of its show to read next. Skips ahead to 'wanted' when
+ * the render path jumped there in the same show; returns 'frameCount'
+ * (show done) when the render path has already left it. A render path
+ * still in the previous show changes nothing.
+ */
+uint32_t readerNextFrame(uint8_t readerSegment, uint8_t renderSegment, uint32_t nextFrame, uint32_t wanted,
+                         uint32_t frameCount);
+
+/**
+ * Reader: takes 'slot' for a frame of 'segment'. A slot last filled by
+ * another show is cleared first: sparse ranges and range reads only
+ * write the channels they cover, the rest must not keep old values.
+ */
+void claimSlot(FrameSlot& slot, uint8_t segment);
+
+/**
+ * Render path: what to do with the slot at the ring tail when it wants
+ * 'frameIdx' of show 'renderSegment'.
+ */
+SlotAction judgeSlot(const FrameSlot& slot, uint8_t renderSegment, uint32_t frameIdx);
@@ -0,0 +1,656 @@
+#include "FseqReader.h"
+#include "DeltaCodec.h"
+#include "ShowCompiler.h"
+#include "Platform.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef ARDUINO
+#include <rom/miniz.h>      // ROM inflater (tinfl) for FSEQ V2 zlib blocks
+#else
+#include <zlib.h>           // Host zlib, driven into the same ring window
+#endif
+
+#define INFLATE_WINDOW_SIZE 32768   // LZ dictionary = ring buffer frames are copied from
+
+/**
+ * Streaming inflater state for the active compressed block.
+ * The window is the 32 KB LZ dictionary; frames are copied out of it as
+ * they are produced, so a block is never inflated as a whole.
+ */
+struct FseqReader::Inflater {
+#ifdef ARDUINO
+  tinfl_decompressor decomp;
+#else
+  z_stream zs;
+  bool     zsReady;
+#endif
+  uint8_t* window;                      // INFLATE_WINDOW_SIZE ring buffer
+  uint8_t  inBuf[FSEQ_INFLATE_CHUNK];
+  size_t   inPos, inLen;
+  int32_t  blockIdx;                    // Block currently being inflated
+  uint32_t consumed;                    // Compressed bytes fetched from the block
+  uint32_t produced;                    // Uncompressed bytes produced so far
+  bool     done;
+};
+
+/**
+ * Decoder state for .lsq shows. Only the current frame and one encoded
+ * record are held in RAM, regardless of show length.
+ */
+struct FseqReader::DeltaState {
+  std::vector<uint8_t> frame;     // Current decoded frame (frameBytes)
+  std::vector<uint8_t> record;    // One encoded record (maxRecord bytes)
+  uint16_t frameBytes = 0;
+  uint16_t maxRecord = 0;
+  uint16_t keyInterval = DELTA_KEY_INTERVAL;
+  uint32_t nextFrame = 0;         // Frame whose record starts at nextOffset
+  uint32_t nextOffset = 0;
+  bool     haveFrame = false;     // 'frame' holds frame nextFrame - 1
+  std::vector<uint32_t> keyIndex; // File offset of every keyframe record
+};
+
+static uint32_t readLe32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool FseqReader::fail(const char* msg) {
+    _error = msg;
+    return false;
+}
+
+void FseqReader::close() {
+    if (_inflater) {
+#ifndef ARDUINO
+        if (_inflater->zsReady) inflateEnd(&_inflater->zs);
+#endif
+        free(_inflater->window);
+        free(_inflater);
+        _inflater = nullptr;
+    }
+    delete _delta;
+    _delta = nullptr;
+
+    _blocks.clear();
+    _blocks.shrink_to_fit();
+    _remap.clear();
+    _physFrame.clear();
+    _physFrame.shrink_to_fit();
+    _physicalReadLen = 0;
+    _reads.clear();
+    _reads.shrink_to_fit();
+    _info = FseqInfo();
+    _src = nullptr;
+    _mapped = nullptr;
+}
+
+/**
+ * Reads the V2 compression block index that follows the 32-byte header.
+ * Block data is stored back-to-back starting at the data offset.
+ */
+bool FseqReader::readBlockIndex(uint16_t blockCount) {
+    _blocks.clear();
+    _blocks.reserve(blockCount);
+
+    uint32_t dataPos = _info.dataOffset;
+    uint8_t entry[8];
+    for (uint16_t i = 0; i < blockCount; i++) {
+        if (_src->readAt(32 + (uint32_t)i * 8, entry, 8) != 8) return false;
+
+        FseqBlock b;
+        b.firstFrame = readLe32(entry);
+        b.length     = readLe32(entry + 4);
+        b.fileOffset = dataPos;
+
+        // xLights pre-allocates the index; unused trailing entries have length 0
+        if (b.length == 0) break;
+        if (!_blocks.empty() && b.firstFrame < _blocks.back().firstFrame) return false;
+
+        _blocks.push_back(b);
+        dataPos += b.length;
+    }
+    _blocks.shrink_to_fit();
+    _info.blockCount = _blocks.size();
+
+    return !_blocks.empty() && dataPos <= _src->size();
+}
+
+/**
+ * Builds the physical-to-logical channel remap from the sparse range table.
+ * An empty table means the file is dense: physical channel N is logical N.
+ */
+bool FseqReader::buildChannelRemap(const std::vector<ChannelSegment>& ranges) {
+    _remap.clear();
+    _physicalReadLen = 0;
+    _info.channelCount = 0;
+
+    uint32_t phys = 0;
+    for (const ChannelSegment& r : ranges) {
+        if (r.logicalStart < LOGICAL_CHANNELS && r.count > 0) {
+            ChannelSegment seg;
+            seg.physOffset   = phys;
+            seg.logicalStart = r.logicalStart;
+            seg.count        = std::min((uint32_t)r.count, (uint32_t)(LOGICAL_CHANNELS - r.logicalStart));
+            _remap.push_back(seg);
+
+            _physicalReadLen   = std::max(_physicalReadLen, seg.physOffset + seg.count);
+            _info.channelCount = std::max(_info.channelCount, (uint32_t)seg.logicalStart + seg.count);
+        }
+        phys += r.count;
+    }
+    if (phys > _info.stride) return false; // Ranges exceed the frame stride
+
+    // Identity layouts are read straight into the caller's buffer, everything else via scratch
+    bool identity = _remap.size() == 1 && _remap[0].physOffset == 0 && _remap[0].logicalStart == 0;
+    _physFrame.assign(identity ? 0 : _physicalReadLen, 0);
+    _physFrame.shrink_to_fit();
+    return !_remap.empty();
+}
+
+/**
+ * Parses a native .lsq header and its keyframe index.
+ * The stream is dense in logical channel order, so the remap is an identity.
+ */
+bool FseqReader::readDeltaHeader(const uint8_t* h) {
+    _delta = new DeltaState();
+    DeltaState& d = *_delta;
+    _info.dataOffset = h[4] | (h[5] << 8);
+    d.frameBytes     = h[6] | (h[7] << 8);
+    _info.frameCount = readLe32(h + 8);
+    _info.stepTimeMs = h[12] | (h[13] << 8);
+    d.keyInterval    = h[14] | (h[15] << 8);
+    uint32_t indexOffset = readLe32(h + 16);
+    uint32_t keyCount    = readLe32(h + 20);
+    d.maxRecord      = h[24] | (h[25] << 8);
+
+    if (d.frameBytes == 0 || d.frameBytes > LOGICAL_CHANNELS || d.keyInterval == 0 || _info.stepTimeMs == 0 ||
+        keyCount != ((uint64_t)_info.frameCount + d.keyInterval - 1) / d.keyInterval) {
+        return fail("Corrupt .lsq show header.");
+    }
+
+    // The index is allocated from the header, so it must fit the file first
+    if (keyCount > _info.frameCount || indexOffset + (uint64_t)keyCount * 4 > _src->size()) {
+        return fail("Truncated .lsq keyframe index.");
+    }
+    d.keyIndex.resize(keyCount);
+    if (_src->readAt(indexOffset, (uint8_t*)d.keyIndex.data(), keyCount * 4) != keyCount * 4) {
+        return fail("Truncated .lsq keyframe index.");
+    }
+
+    d.frame.assign(d.frameBytes, 0);
+    d.record.assign(std::max(d.maxRecord, (uint16_t)1), 0);
+    d.haveFrame = false;
+
+    _info.version = 2;
+    _info.compression = SHOW_CODEC_DELTA;
+    _info.stride = d.frameBytes;
+    _info.announcedFrames = _info.frameCount;
+
+    ChannelSegment all;
+    all.logicalStart = 0;
+    all.count = d.frameBytes;
+    return buildChannelRemap(std::vector<ChannelSegment>(1, all)) || fail("Corrupt .lsq show header.");
+}
+
+/**
+ * Parses a compiled sidecar header: a dense, uncompressed stream with one
+ * byte per LED, so each frame is ~25 bytes instead of a full FSEQ frame.
+ */
+bool FseqReader::readSidecarHeader(const uint8_t* h) {
+    uint16_t ledCount = h[6] | (h[7] << 8);
+    _info.version = 2;
+    _info.compression = SHOW_CODEC_SIDECAR;
+    _info.dataOffset = SIDECAR_HEADER_SIZE;
+    _info.stride = ledCount;
+    _info.frameCount = readLe32(h + 8);
+    _info.announcedFrames = _info.frameCount;
+    _info.stepTimeMs = h[12] | (h[13] << 8);
+    _info.showFingerprint = readLe32(h + 16);
+    _info.configFingerprint = readLe32(h + 20);
+
+    if (ledCount == 0 || _info.stepTimeMs == 0 ||
+        _src->size() < SIDECAR_HEADER_SIZE + (uint64_t)_info.frameCount * ledCount) return false;
+
+    ChannelSegment all;
+    all.logicalStart = 0;
+    all.count = ledCount;
+    return buildChannelRemap(std::vector<ChannelSegment>(1, all));
+}
+
+/**
+ * Walks the variable headers between 'start' and the channel data.
+ * Only 'mf' (media file) is kept; other codes are skipped.
+ */
+void FseqReader::readVariableHeaders(uint32_t start) {
+    _info.mediaFile.clear();
+    uint32_t pos = start;
+    while (pos + 4 <= _info.dataOffset) {
+        uint8_t vh[4];
+        if (_src->readAt(pos, vh, 4) != 4) return;
+
+        uint16_t len = vh[0] | (vh[1] << 8);
+        if (len < 4 || pos + len > _info.dataOffset) return; // Padding reached
+
+        if (vh[2] == 'm' && vh[3] == 'f') {
+            char name[65];
+            size_t n = std::min((uint32_t)(len - 4), (uint32_t)(sizeof(name) - 1));
+            n = _src->readAt(pos + 4, (uint8_t*)name, n);
+            name[n] = 0;
+            _info.mediaFile = name;
+        }
+        pos += len;
+    }
+}
+
+bool FseqReader::open(ByteSource* src) {
+    close();
+    _error = "";
+    if (!src) return fail("No show file");
+    _src = src;
+
+    uint8_t h[32] = { 0 };
+    if (_src->readAt(0, h, 32) < 28) {
+        _src = nullptr;
+        return fail("Show file too short");
+    }
+
+    bool ok = false;
+    // Native delta show (.lsq) and compiled sidecar (.lsc)
+    if (memcmp(h, DELTA_MAGIC, 4) == 0) {
+        ok = readDeltaHeader(h);
+    }
+    else if (memcmp(h, SIDECAR_MAGIC, 4) == 0) {
+        ok = readSidecarHeader(h) || fail("Corrupt or truncated sidecar.");
+    }
+    // Verify Magic Cookie
+    else if (memcmp(h, "PSEQ", 4) != 0) {
+        fail("Not an FSEQ file");
+    }
+    else {
+        _info.dataOffset = (uint16_t)h[4] | ((uint16_t)h[5] << 8);
+        _info.version = h[7];
+        uint16_t varHeaderStart = (uint16_t)h[8] | ((uint16_t)h[9] << 8);
+
+        // Physical channels per frame = frame stride in the file (e.g., 200 in Simon's file)
+        _info.stride = readLe32(h + 10);
+        _info.frameCount = readLe32(h + 14);
+        _info.announcedFrames = _info.frameCount;
+        _info.stepTimeMs = h[18] | (h[19] << 8);
+        ok = _info.stride > 0 || fail("FSEQ has no channels");
+
+        // V2: compression type, block index and sparse ranges
+        std::vector<ChannelSegment> ranges;
+        if (ok && _info.version >= 2) {
+            _info.stepTimeMs = h[18]; // Byte 19 holds flags in V2
+            _info.compression = h[20] & 0x0F;
+            uint16_t blockCount = h[21] | ((uint16_t)(h[20] & 0xF0) << 4);
+            _info.rangeCount = h[22];
+
+            if (_info.compression == FSEQ_COMPRESSION_ZSTD) {
+                ok = fail("FSEQ V2 zstd is not supported. Re-export as V2 zlib or V1.");
+            }
+            else if (_info.compression == FSEQ_COMPRESSION_ZLIB) {
+                ok = readBlockIndex(blockCount) || fail("Corrupt FSEQ V2 block index.");
+                if (ok) {
+                    _inflater = (Inflater*)calloc(1, sizeof(Inflater));
+                    if (_inflater) _inflater->window = (uint8_t*)malloc(INFLATE_WINDOW_SIZE);
+                    ok = (_inflater && _inflater->window) || fail("Not enough heap for the FSEQ V2 inflater.");
+                    if (ok) _inflater->blockIdx = -1;
+                }
+            }
+            else if (_info.compression != FSEQ_COMPRESSION_NONE) {
+                ok = fail("Unknown FSEQ compression type");
+            }
+
+            // Sparse ranges follow the full (pre-allocated) block index
+            uint32_t rangePos = 32 + (uint32_t)blockCount * 8;
+            for (uint8_t i = 0; ok && i < _info.rangeCount; i++) {
+                uint8_t r[6];
+                if (_src->readAt(rangePos + i * 6, r, 6) != 6) { ok = fail("Truncated sparse range table."); break; }
+                uint32_t start = r[0] | ((uint32_t)r[1] << 8) | ((uint32_t)r[2] << 16);
+                uint32_t count = r[3] | ((uint32_t)r[4] << 8) | ((uint32_t)r[5] << 16);
+
+                ChannelSegment range;
+                range.logicalStart = std::min(start, (uint32_t)LOGICAL_CHANNELS);
+                range.count = std::min(count, (uint32_t)0xFFFF);
+                ranges.push_back(range);
+            }
+        }
+        if (ok && _info.stepTimeMs == 0) ok = fail("FSEQ step time is 0");
+
+        if (ok) {
+            // Dense file: one identity range covering the whole stride
+            if (ranges.empty()) {
+                ChannelSegment all;
+                all.logicalStart = 0;
+                all.count = std::min(_info.stride, (uint32_t)0xFFFF);
+                ranges.push_back(all);
+            }
+            ok = buildChannelRemap(ranges) || fail("FSEQ sparse ranges do not match the channel count.");
+        }
+
+        if (ok) {
+            readVariableHeaders(varHeaderStart);
+
+            // Uncompressed files must really contain every frame they announce
+            if (_info.compression == FSEQ_COMPRESSION_NONE) {
+                uint32_t size = _src->size();
+                uint32_t physicalFrames = size > _info.dataOffset ? (size - _info.dataOffset) / _info.stride : 0;
+                _info.frameCount = std::min(_info.frameCount, physicalFrames);
+            }
+        }
+    }
+
+    if (ok && _info.frameCount == 0) ok = fail("Show has no frames");
+    if (ok) _mapped = _src->data();
+    if (!ok) {
+        // Keep the header facts for the caller's error message, drop the buffers
+        const char* error = _error;
+        FseqInfo info = _info;
+        close();
+        _info = info;
+        _error = error;
+    }
+    return ok;
+}
+
+const char* checkShowHeader(const uint8_t* h, size_t len) {
+    if (len < 32) return "Show file too short";
+
+    if (memcmp(h, DELTA_MAGIC, 4) == 0) {
+        uint16_t frameBytes = h[6] | (h[7] << 8);
+        uint16_t stepTimeMs = h[12] | (h[13] << 8);
+        if (frameBytes == 0 || frameBytes > LOGICAL_CHANNELS || stepTimeMs == 0 || readLe32(h + 8) == 0) {
+            return "Corrupt .lsq show header.";
+        }
+        return nullptr;
+    }
+    if (memcmp(h, "PSEQ", 4) != 0) return "Not an FSEQ file";
+
+    uint16_t dataOffset = (uint16_t)h[4] | ((uint16_t)h[5] << 8);
+    uint8_t version = h[7];
+    if (version < 1 || version > 2 || dataOffset < 28) return "Unsupported FSEQ version";
+    if (readLe32(h + 10) == 0) return "FSEQ has no channels";
+    if (readLe32(h + 14) == 0) return "Show has no frames";
+
+    uint16_t stepTimeMs = version >= 2 ? h[18] : (h[18] | (h[19] << 8));
+    if (stepTimeMs == 0) return "FSEQ step time is 0";
+
+    if (version >= 2) {
+        uint8_t compression = h[20] & 0x0F;
+        uint16_t blockCount = h[21] | ((uint16_t)(h[20] & 0xF0) << 4);
+        if (compression == FSEQ_COMPRESSION_ZSTD) return "FSEQ V2 zstd is not supported. Re-export as V2 zlib or V1.";
+        if (compression == FSEQ_COMPRESSION_ZLIB && blockCount == 0) return "Corrupt FSEQ V2 block index.";
+        if (compression != FSEQ_COMPRESSION_NONE && compression != FSEQ_COMPRESSION_ZLIB) {
+            return "Unknown FSEQ compression type";
+        }
+        if (32 + (uint32_t)blockCount * 8 + (uint32_t)h[22] * 6 > dataOffset) return "Truncated sparse range table.";
+    }
+    return nullptr;
+}
+
+std::vector<ChannelRange> coalesceChannels(std::vector<uint16_t> channels, uint16_t maxGap) {
+    std::sort(channels.begin(), channels.end());
+    std::vector<ChannelRange> ranges;
+    for (uint16_t ch : channels) {
+        if (ch >= LOGICAL_CHANNELS) break;
+        if (!ranges.empty()) {
+            ChannelRange& last = ranges.back();
+            uint32_t end = (uint32_t)last.start + last.count;   // First channel after the range
+            if (ch < end) continue;                             // Duplicate
+            if (ch - end <= maxGap) {
+                last.count = ch - last.start + 1;
+                continue;
+            }
+        }
+        ranges.push_back({ ch, 1 });
+    }
+    return ranges;
+}
+
+void FseqReader::setReadRanges(const std::vector<ChannelRange>& ranges) {
+    _reads.clear();
+    if (!_src || _info.compression != FSEQ_COMPRESSION_NONE) return;
+
+    // 1. Cut every range at the sparse segment borders (physically apart)
+    for (const ChannelRange& r : ranges) {
+        for (const ChannelSegment& seg : _remap) {
+            uint32_t a = std::max((uint32_t)r.start, (uint32_t)seg.logicalStart);
+            uint32_t b = std::min((uint32_t)r.start + r.count, (uint32_t)seg.logicalStart + seg.count);
+            if (a >= b) continue;
+
+            ChannelSegment span;
+            span.physOffset   = seg.physOffset + (a - seg.logicalStart);
+            span.logicalStart = a;
+            span.count        = b - a;
+            _reads.push_back(span);
+        }
+    }
+
+    // 2. File order, and join spans that continue each other in both layouts
+    std::sort(_reads.begin(), _reads.end(),
+              [](const ChannelSegment& x, const ChannelSegment& y) { return x.physOffset < y.physOffset; });
+    size_t n = 0;
+    for (size_t i = 0; i < _reads.size(); i++) {
+        if (n > 0 && _reads[n - 1].physOffset + _reads[n - 1].count == _reads[i].physOffset &&
+            _reads[n - 1].logicalStart + _reads[n - 1].count == _reads[i].logicalStart) {
+            _reads[n - 1].count += _reads[i].count;
+        } else {
+            _reads[n++] = _reads[i];
+        }
+    }
+    _reads.resize(n);
+    _reads.shrink_to_fit();
+}
+
+const uint8_t* FseqReader::directFrame(uint32_t frameIdx) const {
+    bool raw = _info.compression == FSEQ_COMPRESSION_NONE || _info.compression == SHOW_CODEC_SIDECAR;
+    if (!_mapped || !raw || !_physFrame.empty() || frameIdx >= _info.frameCount) return nullptr;
+    return _mapped + _info.dataOffset + (size_t)frameIdx * _info.stride;
+}
+
+uint32_t FseqReader::bytesPerFrame() const {
+    if (_reads.empty()) return _physicalReadLen;
+    uint32_t bytes = 0;
+    for (const ChannelSegment& span : _reads) bytes += span.count;
+    return bytes;
+}
+
+/**
+ * Rewinds the inflater to the start of a compression block.
+ */
+void FseqReader::startInflateBlock(int32_t blockIdx) {
+    Inflater& z = *_inflater;
+#ifdef ARDUINO
+    tinfl_init(&z.decomp);
+#else
+    if (z.zsReady) inflateReset(&z.zs);
+    else z.zsReady = inflateInit(&z.zs) == Z_OK;
+#endif
+    z.blockIdx = blockIdx;
+    z.inPos = z.inLen = 0;
+    z.consumed = 0;
+    z.produced = 0;
+    z.done = false;
+}
+
+/**
+ * Copies the part of the stream range [from, to) that overlaps the wanted
+ * frame bytes [frameStart, frameStart + len) out of the ring window.
+ */
+void FseqReader::copyFromWindow(uint32_t from, uint32_t to, uint32_t frameStart, uint8_t* dst, size_t len) {
+    uint32_t a = std::max(from, frameStart);
+    uint32_t b = std::min(to, frameStart + (uint32_t)len);
+    for (uint32_t pos = a; pos < b; ) {
+        uint32_t ring = pos & (INFLATE_WINDOW_SIZE - 1);
+        uint32_t n = std::min(b - pos, (uint32_t)INFLATE_WINDOW_SIZE - ring);
+        memcpy(dst + (pos - frameStart), _inflater->window + ring, n);
+        pos += n;
+    }
+}
+
+/**
+ * Delivers one frame from a zlib-compressed V2 file.
+ * Sequential playback only inflates the bytes of the next frame; a jump
+ * backwards or into another block restarts inflation at that block.
+ */
+bool FseqReader::readCompressedFrame(uint32_t frameIdx, uint8_t* dst, size_t len) {
+    Inflater& z = *_inflater;
+
+    // 1. Locate the block (binary search over the index)
+    size_t lo = 0, hi = _blocks.size();
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (_blocks[mid].firstFrame <= frameIdx) lo = mid; else hi = mid;
+    }
+    const FseqBlock& block = _blocks[lo];
+    uint32_t frameStart = (frameIdx - block.firstFrame) * _info.stride;
+    uint32_t frameEnd   = frameStart + len;
+
+    // 2. Reuse what is still in the window, otherwise restart the block
+    bool inWindow = (z.produced <= frameStart + INFLATE_WINDOW_SIZE);
+    if (z.blockIdx != (int32_t)lo || !inWindow) {
+        startInflateBlock(lo);
+    }
+    copyFromWindow(z.produced > INFLATE_WINDOW_SIZE ? z.produced - INFLATE_WINDOW_SIZE : 0,
+                   z.produced, frameStart, dst, len);
+
+    // 3. Inflate forward until the whole frame has been produced
+    while (z.produced < frameEnd) {
+        if (z.done) return fail("Block ended before the frame did");
+
+        if (z.inPos >= z.inLen && z.consumed < block.length) {
+            size_t want = std::min((uint32_t)FSEQ_INFLATE_CHUNK, block.length - z.consumed);
+            z.inLen = _src->readAt(block.fileOffset + z.consumed, z.inBuf, want);
+            if (z.inLen == 0) return fail("READ ERROR");
+            z.inPos = 0;
+            z.consumed += z.inLen;
+        }
+
+        uint32_t ring = z.produced & (INFLATE_WINDOW_SIZE - 1);
+        size_t inBytes  = z.inLen - z.inPos;
+        size_t outBytes = INFLATE_WINDOW_SIZE - ring;
+        bool moreInput = z.consumed < block.length;
+        bool failed, finished;
+
+#ifdef ARDUINO
+        uint32_t flags = TINFL_FLAG_PARSE_ZLIB_HEADER;
+        if (moreInput) flags |= TINFL_FLAG_HAS_MORE_INPUT;
+        tinfl_status status = tinfl_decompress(&z.decomp, z.inBuf + z.inPos, &inBytes,
+                                               z.window, z.window + ring, &outBytes, flags);
+        failed = status < TINFL_STATUS_DONE;
+        finished = status == TINFL_STATUS_DONE;
+#else
+        z.zs.next_in   = z.inBuf + z.inPos;
+        z.zs.avail_in  = inBytes;
+        z.zs.next_out  = z.window + ring;
+        z.zs.avail_out = outBytes;
+        int status = z.zsReady ? inflate(&z.zs, Z_NO_FLUSH) : Z_STREAM_ERROR;
+        inBytes  -= z.zs.avail_in;
+        outBytes -= z.zs.avail_out;
+        failed = status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR;
+        finished = status == Z_STREAM_END;
+#endif
+        z.inPos += inBytes;
+
+        uint32_t before = z.produced;
+        z.produced += outBytes;
+        copyFromWindow(before, z.produced, frameStart, dst, len);
+
+        // Truncated block: no progress and nothing left to feed
+        if (!finished && inBytes == 0 && outBytes == 0 && !moreInput && z.inPos >= z.inLen) failed = true;
+        if (failed) {
+            z.blockIdx = -1;
+            return fail("INFLATE ERROR");
+        }
+        if (finished) z.done = true;
+    }
+    return true;
+}
+
+/**
+ * Delivers one frame of a .lsq show. Sequential playback decodes one record
+ * per frame; any seek starts at the owning keyframe (O(1) index lookup) and
+ * decodes at most keyInterval - 1 deltas.
+ */
+bool FseqReader::readDeltaFrame(uint32_t frameIdx, uint8_t* dst, size_t len) {
+    DeltaState& d = *_delta;
+    uint32_t key = frameIdx / d.keyInterval;
+    uint32_t keyFrame = key * d.keyInterval;
+
+    // Continue from the current frame if it lies between the keyframe and the target
+    bool reusable = d.haveFrame && d.nextFrame > keyFrame && d.nextFrame <= frameIdx + 1;
+    if (!reusable) {
+        if (key >= d.keyIndex.size()) return fail("Frame beyond the keyframe index");
+        d.nextOffset = d.keyIndex[key];
+        d.nextFrame = keyFrame;
+        d.haveFrame = false;
+    }
+
+    while (!d.haveFrame || d.nextFrame != frameIdx + 1) {
+        uint8_t lenBuf[2];
+        if (_src->readAt(d.nextOffset, lenBuf, 2) != 2) return fail("READ ERROR");
+        uint16_t recLen = lenBuf[0] | (lenBuf[1] << 8);
+        if (recLen > d.maxRecord || _src->readAt(d.nextOffset + 2, d.record.data(), recLen) != recLen) {
+            return fail("READ ERROR");
+        }
+
+        if (d.nextFrame % d.keyInterval == 0) memset(d.frame.data(), 0, d.frameBytes);
+        if (!applyDeltaRecord(d.frame.data(), d.frameBytes, d.record.data(), recLen)) {
+            d.haveFrame = false;
+            return fail("DELTA DECODE ERROR");
+        }
+        d.nextOffset += 2 + recLen;
+        d.nextFrame++;
+        d.haveFrame = true;
+    }
+
+    memcpy(dst, d.frame.data(), std::min((uint32_t)len, (uint32_t)d.frameBytes));
+    return true;
+}
+
+/**
+ * Reads exactly the physical bytes the logical channel space needs (zlib
+ * blocks are inflated on demand) and scatters sparse ranges into their slots.
+ */
+bool FseqReader::readFrame(uint32_t frameIdx, uint8_t* logical) {
+    if (!_src || frameIdx >= _info.frameCount) return fail("Frame out of range");
+
+    // Range reads: only the channels the config uses, already in their logical slots
+    if (!_reads.empty()) {
+        uint32_t framePos = (uint32_t)_info.dataOffset + frameIdx * _info.stride;
+        for (const ChannelSegment& span : _reads) {
+            if (_src->readAt(framePos + span.physOffset, logical + span.logicalStart, span.count) != span.count) {
+                return fail("READ ERROR");
+            }
+        }
+        return true;
+    }
+
+    // 1. FETCH PHYSICAL FRAME
+    // Identity layouts land directly in the caller's buffer, sparse ones go through scratch
+    uint8_t* dst = _physFrame.empty() ? logical : _physFrame.data();
+
+    if (_info.compression == FSEQ_COMPRESSION_ZLIB) {
+        uint32_t inflateStart = engineMicros();
+        bool ok = readCompressedFrame(frameIdx, dst, _physicalReadLen);
+        _inflateMicros = engineMicros() - inflateStart;
+        if (!ok) return false;
+    }
+    else if (_info.compression == SHOW_CODEC_DELTA) {
+        if (!readDeltaFrame(frameIdx, dst, _physicalReadLen)) return false;
+    }
+    else {
+        uint32_t targetPos = (uint32_t)_info.dataOffset + frameIdx * _info.stride;
+        if (_src->readAt(targetPos, dst, _physicalReadLen) != _physicalReadLen) return fail("READ ERROR");
+    }
+
+    // 2. SPARSE REMAP into logical channel slots
+    if (!_physFrame.empty()) {
+        for (const ChannelSegment& seg : _remap) {
+            memcpy(logical + seg.logicalStart, _physFrame.data() + seg.physOffset, seg.count);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,173 @@
+/**
+ * =====================================================================
+ * ShowEngine: show file reader
+ * =====================================================================
+ * Parses every show format the controller plays and delivers frames in
+ * logical channel layout:
+ * - FSEQ V1 and V2 (uncompressed or zlib, dense or sparse)
+ * - native delta/RLE shows (.lsq, see DeltaCodec.h)
+ * - compiled LED-order sidecars (.lsc, see ShowCompiler.h)
+ * V2 zstd is rejected: its decoder window does not fit next to WiFi on
+ * the ESP32-C3 heap.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "ByteSource.h"
+
+#define LOGICAL_CHANNELS 1024     // Logical channel space addressable by configs
+
+// --- Show Formats ---
+#define FSEQ_COMPRESSION_NONE 0
+#define FSEQ_COMPRESSION_ZSTD 1
+#define FSEQ_COMPRESSION_ZLIB 2
+#define SHOW_CODEC_DELTA      0x10  // Pseudo compression type for native .lsq shows
+#define SHOW_CODEC_SIDECAR    0x11  // Pseudo compression type for compiled .lsc sidecars
+#define FSEQ_INFLATE_CHUNK    512   // Compressed bytes pulled from the source per refill
+#define FSEQ_READ_GAP         64    // Unused channels bridged between two range reads
+
+/**
+ * Maps a run of bytes in the physical frame onto logical channel slots.
+ * Dense files produce a single identity segment; V2 sparse files one per range.
+ */
+struct ChannelSegment {
+  uint32_t physOffset;    // Byte offset inside the physical frame
+  uint16_t logicalStart;  // First logical channel of the run
+  uint16_t count;         // Channels kept (clipped to LOGICAL_CHANNELS)
+};
+
+/**
+ * Contiguous run of logical channels (see coalesceChannels()).
+ */
+struct ChannelRange {
+  uint16_t start;
+  uint16_t count;
+};
+
+/**
+ * One entry of the V2 compression block index.
+ * Parsed once in open() so readFrame() never scans the file.
+ */
+struct FseqBlock {
+  uint32_t firstFrame;  // First frame stored in this block
+  uint32_t fileOffset;  // Absolute file position of the compressed data
+  uint32_t length;      // Compressed size in bytes
+};
+
+/**
+ * Header facts of the open show.
+ */
+struct FseqInfo {
+  uint8_t  version = 1;
+  uint8_t  compression = FSEQ_COMPRESSION_NONE;
+  uint16_t dataOffset = 0;
+  uint32_t stride = 0;            // Physical frame stride in bytes
+  uint32_t channelCount = 0;      // Logical channel span after sparse remapping
+  uint32_t frameCount = 0;
+  uint32_t announcedFrames = 0;   // Frame count from the header (before truncation)
+  uint16_t stepTimeMs = 0;
+  uint16_t blockCount = 0;        // V2 zlib blocks in use
+  uint8_t  rangeCount = 0;        // V2 sparse ranges
+  uint32_t showFingerprint = 0;   // Sidecars only: sources they were built from
+  uint32_t configFingerprint = 0;
+  std::string mediaFile;          // 'mf' variable header (audio file name)
+};
+
+class FseqReader {
+public:
+    ~FseqReader() { close(); }
+
+    /**
+     * Parses the header of 'src' and prepares the decoder.
+     * The source must outlive the reader or the next close().
+     */
+    bool open(ByteSource* src);
+
+    /**
+     * Frees all decoder buffers. The inflater alone takes ~43 KB, so it
+     * only lives on the heap while a compressed show is open.
+     */
+    void close();
+
+    /**
+     * Reads one frame into a logical channel buffer (LOGICAL_CHANNELS bytes).
+     * Slots outside the sparse ranges are not written, so callers clear the
+     * buffer once per show.
+     */
+    bool readFrame(uint32_t frameIdx, uint8_t* logical);
+
+    /**
+     * Limits readFrame() to the given logical ranges, one read per range
+     * straight into its slots. Applies to uncompressed FSEQ only: zlib
+     * and .lsq streams decode whole frames anyway, sidecars are already
+     * LED order. An empty list restores full-frame reads.
+     */
+    void setReadRanges(const std::vector<ChannelRange>& ranges);
+
+    /**
+     * Zero-copy access: the frame's bytes in place when the source is
+     * memory mapped and needs no decoding (uncompressed, dense from
+     * channel 0, or a sidecar). Only the first info().stride bytes
+     * belong to the frame. nullptr otherwise.
+     */
+    const uint8_t* directFrame(uint32_t frameIdx) const;
+    uint32_t bytesPerFrame() const;   // Physical bytes fetched per frame
+    uint16_t readsPerFrame() const { return _reads.empty() ? 1 : _reads.size(); }
+
+    bool isOpen() const { return _src != nullptr; }
+    const FseqInfo& info() const { return _info; }
+    const std::vector<ChannelSegment>& channelRemap() const { return _remap; }
+    const char* lastError() const { return _error; }
+    uint32_t inflateMicros() const { return _inflateMicros; }
+
+private:
+    struct Inflater;
+    struct DeltaState;
+
+    bool fail(const char* msg);
+    bool readBlockIndex(uint16_t blockCount);
+    bool buildChannelRemap(const std::vector<ChannelSegment>& ranges);
+    bool readDeltaHeader(const uint8_t* h);
+    bool readSidecarHeader(const uint8_t* h);
+    void readVariableHeaders(uint32_t start);
+
+    void startInflateBlock(int32_t blockIdx);
+    void copyFromWindow(uint32_t from, uint32_t to, uint32_t frameStart, uint8_t* dst, size_t len);
+    bool readCompressedFrame(uint32_t frameIdx, uint8_t* dst, size_t len);
+    bool readDeltaFrame(uint32_t frameIdx, uint8_t* dst, size_t len);
+
+    ByteSource* _src = nullptr;
+    const uint8_t* _mapped = nullptr;  // _src->data(), if memory mapped
+    FseqInfo _info;
+    const char* _error = "";
+
+    std::vector<ChannelSegment> _remap;
+    std::vector<uint8_t> _physFrame;   // Scratch for non-identity layouts
+    uint32_t _physicalReadLen = 0;     // Bytes fetched from each physical frame
+    std::vector<ChannelSegment> _reads; // Range reads (setReadRanges), empty = whole frame
+
+    std::vector<FseqBlock> _blocks;
+    Inflater* _inflater = nullptr;
+    DeltaState* _delta = nullptr;
+    uint32_t _inflateMicros = 0;       // Decompression time of the last frame
+};
+
+/**
+ * Quick check of a show's first 32 bytes (FSEQ V1/V2 or .lsq) before it
+ * is stored, e.g. from the first upload chunk. Returns nullptr if the
+ * reader can play it, otherwise the same message open() would give.
+ * Block index, ranges and frame data are checked by open() later.
+ */
+const char* checkShowHeader(const uint8_t* h, size_t len);
+
+/**
+ * Merges the logical channels a config uses into the fewest contiguous
+ * ranges. Gaps of up to 'maxGap' unused channels are read along: one
+ * longer read costs less than another seek. Channels at or beyond
+ * LOGICAL_CHANNELS (dead LEDs) are skipped.
+ */
+std::vector<ChannelRange> coalesceChannels(std::vector<uint16_t> channels, uint16_t maxGap);
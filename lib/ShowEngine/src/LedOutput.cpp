@@ -0,0 +1,55 @@
+#include "LedOutput.h"
+#include <algorithm>
+
+uint32_t stripWireUs(uint16_t count) {
+    return (uint32_t)count * 24 * WS2812_BIT_NS / 1000 + WS2812_LATCH_US;
+}
+
+uint32_t outputWireUs(const std::vector<LedStrip>& strips, uint8_t channels) {
+    uint32_t freeAt[LED_MAX_OUTPUTS] = { 0 };
+    channels = std::max((uint8_t)1, std::min(channels, (uint8_t)LED_MAX_OUTPUTS));
+    uint32_t done = 0;
+    for (const LedStrip& s : strips) {
+        if (s.count == 0) continue;
+        uint32_t* ch = std::min_element(freeAt, freeAt + channels);
+        *ch += stripWireUs(s.count);
+        done = std::max(done, *ch);
+    }
+    return done;
+}
+
+bool layoutStrips(std::vector<LedStrip>& strips, uint16_t ledCount, uint8_t defaultPin) {
+    if (strips.empty()) {
+        LedStrip all;
+        all.pin = defaultPin;
+        all.count = ledCount;
+        strips.push_back(all);
+        return true;
+    }
+    if (strips.size() > LED_MAX_OUTPUTS) strips.resize(LED_MAX_OUTPUTS);
+
+    uint16_t next = 0;
+    for (LedStrip& s : strips) {
+        s.first = next;
+        s.count = std::min(s.count, (uint16_t)(ledCount - next));
+        next += s.count;
+    }
+    return next == ledCount;
+}
+
+bool MockLedOutput::begin(const std::vector<LedStrip>& strips) {
+    _strips = strips;
+    return true;
+}
+
+void MockLedOutput::show(uint8_t brightness) {
+    _brightness = brightness;
+
+    // FastLED waits for the previous frame before it starts the next
+    uint64_t start = std::max(_nowUs, _doneUs);
+    if (start > _nowUs) _stalls++;
+    _doneUs = start + outputWireUs(_strips, _channels);
+    _lastBusyUs = (uint32_t)(_doneUs - _nowUs);
+    _maxBusyUs = std::max(_maxBusyUs, _lastBusyUs);
+    _frames++;
+}
@@ -0,0 +1,99 @@
+/**
+ * =====================================================================
+ * ShowEngine: LED output layout and timing
+ * =====================================================================
+ * A config can split its LEDs over several data pins ("outputs"). Each
+ * strip is a contiguous range of the LED buffer; the C3 has two RMT
+ * transmitters, so two strips are sent at the same time and further
+ * ones wait for a free transmitter.
+ *
+ * WS2812 timing: 24 bits of 1.25 us per LED, then a latch gap.
+ * 100 LEDs on one pin take 3.3 ms; 600 LEDs take 18.3 ms, the limit for
+ * 20 ms frames.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#define WS2812_BIT_NS    1250
+#define WS2812_LATCH_US  280      // Reset gap of current WS2812B parts
+#define LED_RMT_CHANNELS 2        // RMT transmitters of the ESP32-C3
+#define LED_MAX_OUTPUTS  4        // Strips per config
+
+struct LedStrip {
+  uint8_t pin = 0;
+  uint16_t first = 0;          // First LED in the buffer
+  uint16_t count = 0;
+};
+
+/**
+ * Transmit time of one strip including the latch (us).
+ */
+uint32_t stripWireUs(uint16_t count);
+
+/**
+ * Time until all strips have latched (us) when they start together and
+ * each one takes the first free of 'channels' transmitters, in order.
+ */
+uint32_t outputWireUs(const std::vector<LedStrip>& strips, uint8_t channels = LED_RMT_CHANNELS);
+
+/**
+ * Lays 'ledCount' LEDs out over the strips in config order: sets 'first'
+ * and cuts counts beyond the end. No strips: everything on 'defaultPin'.
+ * False if LEDs are left without a strip (they are not shown).
+ */
+bool layoutStrips(std::vector<LedStrip>& strips, uint16_t ledCount, uint8_t defaultPin);
+
+/**
+ * Output driver: FastLED on the device, MockLedOutput on the host.
+ */
+class LedOutput {
+public:
+    virtual ~LedOutput() {}
+
+    /**
+     * Assigns the strips (pins and LED ranges of the pixel buffer).
+     */
+    virtual bool begin(const std::vector<LedStrip>& strips) = 0;
+
+    /**
+     * Sends the pixel buffer at 'brightness' (0-255, the power limit is
+     * already applied) to all strips; returns once all have latched.
+     */
+    virtual void show(uint8_t brightness) = 0;
+};
+
+/**
+ * Host stand-in without pins: each show() is timed the way the RMT
+ * transmitters would send it, starting at the time set by setNow().
+ * A show() before the previous frame has latched waits for it (stall).
+ */
+class MockLedOutput : public LedOutput {
+public:
+    explicit MockLedOutput(uint8_t channels = LED_RMT_CHANNELS) : _channels(channels ? channels : 1) {}
+
+    bool begin(const std::vector<LedStrip>& strips) override;
+    void show(uint8_t brightness) override;
+
+    void setNow(uint64_t nowUs) { _nowUs = nowUs; }
+
+    uint64_t doneUs() const { return _doneUs; }        // Last frame latched
+    uint32_t lastBusyUs() const { return _lastBusyUs; } // show() call to latch, stall included
+    uint32_t maxBusyUs() const { return _maxBusyUs; }
+    uint32_t frames() const { return _frames; }
+    uint32_t stalls() const { return _stalls; }
+    uint8_t brightness() const { return _brightness; }  // Of the last frame
+
+private:
+    uint8_t _channels;
+    std::vector<LedStrip> _strips;
+    uint64_t _nowUs = 0;
+    uint64_t _doneUs = 0;
+    uint32_t _lastBusyUs = 0;
+    uint32_t _maxBusyUs = 0;
+    uint32_t _frames = 0;
+    uint32_t _stalls = 0;
+    uint8_t _brightness = 0;
+};
@@ -0,0 +1,77 @@
+#include "PipelineMetrics.h"
+#include <stdio.h>
+
+static const uint32_t bucketLimits[STAGE_BUCKETS] = { 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 0 };
+
+static const char* const stageNames[STAGE_COUNT] = { "seek", "read", "wait", "map", "show", "blend", "frame" };
+
+uint32_t StageHistogram::bucketLimitUs(uint8_t bucket) {
+    return bucket < STAGE_BUCKETS ? bucketLimits[bucket] : 0;
+}
+
+void StageHistogram::add(uint32_t us) {
+    uint8_t b = 0;
+    while (b < STAGE_BUCKETS - 1 && us > bucketLimits[b]) b++;
+    buckets[b]++;
+    sumUs += us;
+    count++;
+}
+
+const char* PipelineMetrics::stageName(PipelineStage stage) {
+    return stage < STAGE_COUNT ? stageNames[stage] : "unknown";
+}
+
+bool PipelineMetrics::writePrometheus(ByteSink& out, const char* name, const char* help) const {
+    bool ok = writePrometheusHeader(out, name, "histogram", help);
+    for (uint8_t s = 0; ok && s < STAGE_COUNT; s++) {
+        char label[24];
+        snprintf(label, sizeof(label), "stage=\"%s\"", stageNames[s]);
+        ok = writePrometheusHistogram(out, name, label, _stages[s]);
+    }
+    return ok;
+}
+
+static bool writeText(ByteSink& out, const char* text, int n) {
+    return n > 0 && out.write((const uint8_t*)text, n) == (size_t)n;
+}
+
+bool writePrometheusHeader(ByteSink& out, const char* name, const char* type, const char* help) {
+    char buf[192];
+    int n = snprintf(buf, sizeof(buf), "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    return n < (int)sizeof(buf) && writeText(out, buf, n);
+}
+
+bool writePrometheusHistogram(ByteSink& out, const char* name, const char* label, const StageHistogram& h) {
+    char buf[128];
+    const char* sep = label && *label ? "," : "";
+    if (!label) label = "";
+
+    // Prometheus buckets count everything up to their bound
+    uint32_t cumulative = 0;
+    bool ok = true;
+    for (uint8_t b = 0; ok && b < STAGE_BUCKETS; b++) {
+        cumulative += h.buckets[b];
+        int n;
+        if (bucketLimits[b]) {
+            n = snprintf(buf, sizeof(buf), "%s_bucket{%s%sle=\"%u.%06u\"} %u\n", name, label, sep,
+                         (unsigned)(bucketLimits[b] / 1000000), (unsigned)(bucketLimits[b] % 1000000),
+                         (unsigned)cumulative);
+        } else {
+            n = snprintf(buf, sizeof(buf), "%s_bucket{%s%sle=\"+Inf\"} %u\n", name, label, sep, (unsigned)cumulative);
+        }
+        ok = n < (int)sizeof(buf) && writeText(out, buf, n);
+    }
+
+    const char* lbrace = *label ? "{" : "";
+    const char* rbrace = *label ? "}" : "";
+    int n = snprintf(buf, sizeof(buf), "%s_sum%s%s%s %llu.%06u\n%s_count%s%s%s %u\n", name, lbrace, label, rbrace,
+                     (unsigned long long)(h.sumUs / 1000000), (unsigned)(h.sumUs % 1000000), name, lbrace, label,
+                     rbrace, (unsigned)h.count);
+    return ok && n < (int)sizeof(buf) && writeText(out, buf, n);
+}
+
+bool writePrometheusValue(ByteSink& out, const char* name, const char* type, const char* help, uint64_t value) {
+    char buf[96];
+    int n = snprintf(buf, sizeof(buf), "%s %llu\n", name, (unsigned long long)value);
+    return writePrometheusHeader(out, name, type, help) && n < (int)sizeof(buf) && writeText(out, buf, n);
+}
@@ -0,0 +1,71 @@
+/**
+ * =====================================================================
+ * ShowEngine: frame pipeline metrics
+ * =====================================================================
+ * Always-on timing of every stage a frame passes through, from the file
+ * to the LEDs, in fixed microsecond buckets. Counts only ever grow
+ * (since boot), so a Prometheus scraper can take rates and quantiles
+ * over any window of a rehearsal.
+ *
+ * Each stage has one writer (the reader task: seek, read; the render
+ * task: the rest), so no lock is needed. A scrape during a show may see
+ * a count that is one sample ahead of its buckets.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include "ByteSource.h"
+
+#define STAGE_BUCKETS 11   // Upper bounds 50 us ... 50 ms, the last one open (+Inf)
+
+enum PipelineStage : uint8_t {
+  STAGE_SEEK,    // File seek before a frame (reader task)
+  STAGE_READ,    // Read and decode/inflate of a frame (reader task)
+  STAGE_WAIT,    // Render path waiting for the frame in the ring
+  STAGE_MAP,     // Channels to LED colors
+  STAGE_SHOW,    // Handing the LED buffer to the outputs
+  STAGE_BLEND,   // One interpolation tick (map + show)
+  STAGE_FRAME,   // playFrame() as a whole
+  STAGE_COUNT
+};
+
+struct StageHistogram {
+  uint32_t buckets[STAGE_BUCKETS] = { 0 };   // Samples per bucket (not cumulative)
+  uint32_t count = 0;
+  uint64_t sumUs = 0;
+
+  void add(uint32_t us);
+  static uint32_t bucketLimitUs(uint8_t bucket);   // Upper bound of a bucket (0 = open)
+};
+
+class PipelineMetrics {
+public:
+    void add(PipelineStage stage, uint32_t us) { _stages[stage].add(us); }
+    const StageHistogram& stage(PipelineStage stage) const { return _stages[stage]; }
+    static const char* stageName(PipelineStage stage);
+
+    /**
+     * Writes all stages as one Prometheus histogram ('name', label "stage").
+     */
+    bool writePrometheus(ByteSink& out, const char* name, const char* help) const;
+
+private:
+    StageHistogram _stages[STAGE_COUNT];
+};
+
+/**
+ * Prometheus text format (version 0.0.4): "# HELP" and "# TYPE" lines.
+ */
+bool writePrometheusHeader(ByteSink& out, const char* name, const char* type, const char* help);
+
+/**
+ * Sample lines of a histogram in seconds: cumulative _bucket lines, _sum
+ * and _count. 'label' is an optional extra label, e.g. stage="read".
+ */
+bool writePrometheusHistogram(ByteSink& out, const char* name, const char* label, const StageHistogram& h);
+
+/**
+ * A counter or gauge with its header.
+ */
+bool writePrometheusValue(ByteSink& out, const char* name, const char* type, const char* help, uint64_t value);
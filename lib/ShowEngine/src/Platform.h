@@ -0,0 +1,37 @@
+/**
+ * =====================================================================
+ * ShowEngine: platform glue
+ * =====================================================================
+ * The engine only needs microsecond clocks and a cooperative yield.
+ * engineMicros() wraps after ~71 minutes and is only used for durations;
+ * engineMicros64() never wraps and drives the frame clock.
+ * On the ESP32 these come from the Arduino core; the native (host) build
+ * uses std::chrono so the same code can be profiled on Linux.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_timer.h>
+
+inline uint32_t engineMicros() { return micros(); }
+inline uint64_t engineMicros64() { return (uint64_t)esp_timer_get_time(); }
+inline void engineYield() { yield(); }
+
+#else
+#include <chrono>
+
+inline uint32_t engineMicros() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+inline uint64_t engineMicros64() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+inline void engineYield() {}
+
+#endif
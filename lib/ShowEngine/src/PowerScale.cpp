@@ -0,0 +1,70 @@
+#include "PowerScale.h"
+#include "FseqReader.h"
+#include "Platform.h"
+#include <string.h>
+#include <vector>
+
+struct PowerPixel {
+  uint8_t r, g, b;
+};
+
+static void putLe32(uint8_t* p, uint32_t v) {
+    for (uint8_t i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t getLe32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint8_t limitBrightness(uint32_t unscaledMw, uint8_t brightness, uint32_t maxMw) {
+    uint32_t requested = unscaledMw * brightness / 256;
+    if (requested <= maxMw) return brightness;
+    return (uint32_t)brightness * maxMw / requested;
+}
+
+void encodePowerHeader(const PowerHeader& header, uint8_t* out) {
+    memcpy(out, POWER_MAGIC, 4);
+    putLe32(out + 4, header.frameCount);
+    putLe32(out + 8, header.showFingerprint);
+    putLe32(out + 12, header.configFingerprint);
+}
+
+bool decodePowerHeader(const uint8_t* in, PowerHeader& header) {
+    if (memcmp(in, POWER_MAGIC, 4) != 0) return false;
+    header.frameCount = getLe32(in + 4);
+    header.showFingerprint = getLe32(in + 8);
+    header.configFingerprint = getLe32(in + 12);
+    return true;
+}
+
+bool compilePowerScales(FseqReader& src, const LedMapTable& map, uint8_t brightness, uint32_t maxMw,
+                        const PowerHeader& header, ByteSink& out, PowerStats& stats) {
+    uint8_t h[POWER_HEADER_SIZE];
+    encodePowerHeader(header, h);
+    bool ok = out.write(h, sizeof(h)) == sizeof(h);
+
+    static uint8_t frame[LOGICAL_CHANNELS];
+    static uint8_t batch[512];
+    memset(frame, 0, sizeof(frame)); // Channels outside sparse ranges stay black
+    std::vector<PowerPixel> pixels(map.count);
+    size_t batchLen = 0;
+
+    for (uint32_t f = 0; ok && f < header.frameCount; f++) {
+        if (!src.readFrame(f, frame)) {
+            stats.failedFrame = f;
+            return false;
+        }
+        mapFrameToLeds(frame, map, pixels.data());
+        uint8_t b = limitBrightness(unscaledPowerMw(pixels.data(), map.count), brightness, maxMw);
+        if (b < brightness) stats.limitedFrames++;
+        if (b < stats.minBrightness) stats.minBrightness = b;
+
+        batch[batchLen++] = b;
+        if (batchLen == sizeof(batch)) {
+            ok = out.write(batch, batchLen) == batchLen;
+            batchLen = 0;
+        }
+        if ((f & 63) == 0) engineYield();
+    }
+    return ok && (batchLen == 0 || out.write(batch, batchLen) == batchLen);
+}
@@ -0,0 +1,74 @@
+/**
+ * =====================================================================
+ * ShowEngine: power limit (per-frame brightness sidecar, .lsp)
+ * =====================================================================
+ * The current limit of a config is a brightness per frame: the config's
+ * max_brightness, lowered for frames that would draw more than
+ * max_milliamps. The estimate is FastLED's power model (5 V, mW per
+ * color at full value, idle draw per LED and for the MCU), so limited
+ * frames look as they did with setMaxPowerInVoltsAndMilliamps().
+ *
+ * Header (16 bytes, little endian):
+ *   0 "LSP1" | 4 frame count | 8 show fingerprint | 12 config fingerprint
+ * One brightness byte per frame follows.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include "ByteSource.h"
+#include "ChannelMapper.h"
+
+#define POWER_MAGIC       "LSP1"
+#define POWER_HEADER_SIZE 16
+#define POWER_VOLTS       5
+#define POWER_RED_MW      (16 * POWER_VOLTS)   // One LED at full value
+#define POWER_GREEN_MW    (11 * POWER_VOLTS)
+#define POWER_BLUE_MW     (15 * POWER_VOLTS)
+#define POWER_DARK_MW     (1 * POWER_VOLTS)    // Idle draw per LED
+#define POWER_MCU_MW      (25 * POWER_VOLTS)
+
+class FseqReader;
+
+struct PowerHeader {
+  uint32_t frameCount = 0;
+  uint32_t showFingerprint = 0;
+  uint32_t configFingerprint = 0;
+};
+
+struct PowerStats {
+  uint32_t limitedFrames = 0;   // Frames below the configured brightness
+  uint8_t minBrightness = 255;
+  uint32_t failedFrame = 0;
+};
+
+/**
+ * Draw of the pixels at full brightness (mW), MCU included.
+ */
+template <typename Pixel>
+uint32_t unscaledPowerMw(const Pixel* pixels, uint16_t count) {
+    uint32_t r = 0, g = 0, b = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        r += pixels[i].r;
+        g += pixels[i].g;
+        b += pixels[i].b;
+    }
+    return ((r * POWER_RED_MW) >> 8) + ((g * POWER_GREEN_MW) >> 8) + ((b * POWER_BLUE_MW) >> 8) +
+           count * POWER_DARK_MW + POWER_MCU_MW;
+}
+
+/**
+ * Highest brightness up to 'brightness' that keeps the draw within
+ * 'maxMw' (FastLED's calculate_max_brightness_for_power_mW()).
+ */
+uint8_t limitBrightness(uint32_t unscaledMw, uint8_t brightness, uint32_t maxMw);
+
+void encodePowerHeader(const PowerHeader& header, uint8_t* out);
+bool decodePowerHeader(const uint8_t* in, PowerHeader& header);
+
+/**
+ * Maps every frame of an open show through 'map' (channel or LED order,
+ * matching the source) and writes its brightness limit.
+ */
+bool compilePowerScales(FseqReader& src, const LedMapTable& map, uint8_t brightness, uint32_t maxMw,
+                        const PowerHeader& header, ByteSink& out, PowerStats& stats);
@@ -0,0 +1,44 @@
+#include "ShowCompiler.h"
+#include "FseqReader.h"
+#include "Platform.h"
+#include <string.h>
+
+bool compileSidecar(FseqReader& src, const std::vector<LedMapping>& leds,
+                    uint32_t showFingerprint, uint32_t configFingerprint, ByteSink& out) {
+    const FseqInfo& info = src.info();
+    uint16_t ledCount = leds.size();
+    uint32_t frameCount = info.frameCount;
+    uint16_t stepTimeMs = info.stepTimeMs;
+
+    uint8_t h[SIDECAR_HEADER_SIZE] = { 0 };
+    memcpy(h, SIDECAR_MAGIC, 4);
+    h[4] = SIDECAR_HEADER_SIZE;
+    h[6] = ledCount & 0xFF;         h[7] = ledCount >> 8;
+    h[8] = frameCount & 0xFF;       h[9] = (frameCount >> 8) & 0xFF;
+    h[10] = (frameCount >> 16) & 0xFF; h[11] = frameCount >> 24;
+    h[12] = stepTimeMs & 0xFF;      h[13] = stepTimeMs >> 8;
+    memcpy(h + 16, &showFingerprint, 4);
+    memcpy(h + 20, &configFingerprint, 4);
+    bool ok = out.write(h, SIDECAR_HEADER_SIZE) == SIDECAR_HEADER_SIZE;
+
+    static uint8_t logical[LOGICAL_CHANNELS];
+    static uint8_t batch[SIDECAR_BATCH];
+    memset(logical, 0, sizeof(logical)); // Channels outside sparse ranges stay black
+    size_t batchLen = 0;
+
+    for (uint32_t f = 0; ok && f < frameCount; f++) {
+        if (!src.readFrame(f, logical)) { ok = false; break; }
+
+        if (batchLen + ledCount > sizeof(batch)) {
+            ok = out.write(batch, batchLen) == batchLen;
+            batchLen = 0;
+        }
+        for (uint16_t i = 0; i < ledCount; i++) {
+            uint16_t ch = leds[i].channel;
+            batch[batchLen++] = (ch < LOGICAL_CHANNELS) ? logical[ch] : 0;
+        }
+        if ((f & 63) == 0) engineYield();
+    }
+    if (ok && batchLen) ok = out.write(batch, batchLen) == batchLen;
+    return ok;
+}
@@ -0,0 +1,29 @@
+/**
+ * =====================================================================
+ * ShowEngine: show compiler (config-specific sidecar, .lsc)
+ * =====================================================================
+ * Header (32 bytes, little endian):
+ *   0 "LSC1" | 4 header size | 6 LED count | 8 frame count
+ *   12 step time (ms) | 16 show fingerprint | 20 config fingerprint
+ * Frames follow densely, one byte per LED in LED order.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "ByteSource.h"
+#include "ChannelMapper.h"
+
+#define SIDECAR_MAGIC       "LSC1"
+#define SIDECAR_HEADER_SIZE 32
+#define SIDECAR_BATCH       2048   // Output bytes buffered per sink write
+
+class FseqReader;
+
+/**
+ * Writes the channels 'leds' references, in LED order, for every frame of
+ * an open show. The fingerprints are stored so stale sidecars are detected.
+ */
+bool compileSidecar(FseqReader& src, const std::vector<LedMapping>& leds,
+                    uint32_t showFingerprint, uint32_t configFingerprint, ByteSink& out);
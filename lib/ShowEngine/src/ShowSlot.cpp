@@ -0,0 +1,28 @@
+#include "ShowSlot.h"
+#include <string.h>
+
+static void putLe32(uint8_t* p, uint32_t v) {
+    for (uint8_t i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t getLe32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void encodeSlotHeader(const ShowSlotHeader& header, uint8_t* out) {
+    memset(out, 0, SLOT_HEADER_SIZE);
+    memcpy(out, SLOT_MAGIC, 4);
+    putLe32(out + 4, header.length);
+    putLe32(out + 8, header.fingerprint);
+    size_t len = strnlen(header.name, SLOT_NAME_LEN - 1);
+    memcpy(out + 16, header.name, len);
+}
+
+bool decodeSlotHeader(const uint8_t* in, uint32_t capacity, ShowSlotHeader& header) {
+    if (memcmp(in, SLOT_MAGIC, 4) != 0 || capacity < SLOT_HEADER_SIZE) return false;
+    header.length = getLe32(in + 4);
+    header.fingerprint = getLe32(in + 8);
+    memcpy(header.name, in + 16, SLOT_NAME_LEN);
+    header.name[SLOT_NAME_LEN - 1] = 0;
+    return header.length > 0 && header.length <= capacity - SLOT_HEADER_SIZE;
+}
@@ -0,0 +1,39 @@
+/**
+ * =====================================================================
+ * ShowEngine: raw flash show slot
+ * =====================================================================
+ * A data partition that holds one show byte for byte, without a file
+ * system. It is memory mapped for playback, so uncompressed frames are
+ * used in place (see FseqReader::directFrame()).
+ *
+ * Header (64 bytes, little endian), written last so an interrupted copy
+ * leaves an empty slot:
+ *   0 "LSS1" | 4 show length | 8 source fingerprint | 12 reserved
+ *   16 show name (48 bytes, zero padded)
+ * The show follows at SLOT_HEADER_SIZE.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define SLOT_MAGIC       "LSS1"
+#define SLOT_HEADER_SIZE 64
+#define SLOT_NAME_LEN    48
+
+struct ShowSlotHeader {
+  uint32_t length = 0;          // Show bytes after the header
+  uint32_t fingerprint = 0;     // Of the LittleFS file the slot was copied from
+  char name[SLOT_NAME_LEN] = { 0 };
+};
+
+/**
+ * Writes SLOT_HEADER_SIZE bytes to 'out'. Names are cut to fit.
+ */
+void encodeSlotHeader(const ShowSlotHeader& header, uint8_t* out);
+
+/**
+ * False for an erased or interrupted slot, or a show longer than the
+ * partition ('capacity' bytes including the header).
+ */
+bool decodeSlotHeader(const uint8_t* in, uint32_t capacity, ShowSlotHeader& header);
@@ -0,0 +1,61 @@
+#include "TimeSync.h"
+#include <stdlib.h>
+#include <algorithm>
+
+TimeSyncResult estimateClockOffset(const TimeSyncSample* samples, size_t count) {
+    TimeSyncResult result;
+    if (count > TIME_SYNC_MAX_SAMPLES) count = TIME_SYNC_MAX_SAMPLES;
+
+    // 1. Offset and RTT per round
+    int64_t offsets[TIME_SYNC_MAX_SAMPLES];
+    int64_t rtts[TIME_SYNC_MAX_SAMPLES];
+    size_t n = 0;
+    int64_t minRtt = INT64_MAX;
+    for (size_t i = 0; i < count; i++) {
+        const TimeSyncSample& s = samples[i];
+        int64_t rtt = (s.t4 - s.t1) - (s.t3 - s.t2);
+        if (rtt < 0) continue;
+        offsets[n] = ((s.t2 - s.t1) + (s.t3 - s.t4)) / 2;
+        rtts[n] = rtt;
+        if (rtt < minRtt) minRtt = rtt;
+        n++;
+    }
+    if (!n) return result;
+
+    // 2. Outlier rejection: keep rounds close to the fastest one
+    int64_t limit = minRtt + std::max<int64_t>(minRtt / 2, TIME_SYNC_RTT_SLACK);
+    int64_t kept[TIME_SYNC_MAX_SAMPLES];
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (rtts[i] <= limit) kept[k++] = offsets[i];
+    }
+
+    // 3. Median of the remaining offsets
+    std::sort(kept, kept + k);
+    result.offsetUs = (k & 1) ? kept[k / 2] : (kept[k / 2 - 1] + kept[k / 2]) / 2;
+    result.rttUs = (uint32_t)minRtt;
+    result.spreadUs = (uint32_t)(kept[k - 1] - kept[0]);
+    result.used = (uint8_t)k;
+    result.valid = true;
+    return result;
+}
+
+size_t parseTimeSyncSamples(const char* text, TimeSyncSample* out, size_t max) {
+    size_t count = 0;
+    const char* p = text;
+    while (p && *p && count < max) {
+        int64_t t[4];
+        char* end = nullptr;
+        bool ok = true;
+        for (int i = 0; i < 4 && ok; i++) {
+            t[i] = strtoll(p, &end, 10);
+            ok = end != p && (i == 3 || *end == ',');
+            p = (i < 3 && ok) ? end + 1 : end;
+        }
+        if (!ok) break;
+        out[count++] = { t[0], t[1], t[2], t[3] };
+        if (*p != ';') break;
+        p++;
+    }
+    return count;
+}
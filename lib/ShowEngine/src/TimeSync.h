@@ -0,0 +1,47 @@
+/**
+ * =====================================================================
+ * ShowEngine: browser clock sync (NTP-style offset estimation)
+ * =====================================================================
+ * The browser runs several request/response rounds against the
+ * controller and records four timestamps per round (microseconds):
+ *   t1 browser send | t2 controller receive | t3 controller send | t4 browser receive
+ *
+ *   offset = ((t2 - t1) + (t3 - t4)) / 2     controller clock - browser clock
+ *   rtt    = (t4 - t1) - (t3 - t2)           network time of the round
+ *
+ * The error of one round is at most rtt / 2 (fully asymmetric path), so
+ * rounds far slower than the fastest one are dropped and the median
+ * offset of the rest is used.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TIME_SYNC_MAX_SAMPLES 16
+#define TIME_SYNC_RTT_SLACK   2000   // us above the fastest round that still count
+
+struct TimeSyncSample {
+  int64_t t1, t2, t3, t4;
+};
+
+struct TimeSyncResult {
+  bool valid = false;
+  int64_t offsetUs = 0;     // Controller clock minus browser clock
+  uint32_t rttUs = 0;       // Fastest round trip
+  uint32_t spreadUs = 0;    // Range of the offsets that were used
+  uint8_t used = 0;         // Rounds that passed the RTT filter
+};
+
+/**
+ * Estimates the clock offset from up to TIME_SYNC_MAX_SAMPLES rounds.
+ * Rounds with a negative RTT (corrupt timestamps) are ignored.
+ */
+TimeSyncResult estimateClockOffset(const TimeSyncSample* samples, size_t count);
+
+/**
+ * Parses "t1,t2,t3,t4;t1,t2,t3,t4;..." as sent by the web UI.
+ * Returns the number of samples stored (at most 'max').
+ */
+size_t parseTimeSyncSamples(const char* text, TimeSyncSample* out, size_t max);
@@ -28,7 +28,7 @@ def merge_binaries(source, target, env, **kwargs):
         flash_images.extend(["0xe000", otadata_bin])
 
     fs_offset = None
-    partitions_csv = os.path.join(project_dir, "partitions.csv")
+    partitions_csv = os.path.join(project_dir, env.GetProjectOption("board_build.partitions", "partitions.csv"))
     
     if os.path.exists(partitions_csv):
         with open(partitions_csv, "r") as f:
@@ -0,0 +1,81 @@
+/**
+ * LED output through FastLED (see LedOutput.h). Pins are template
+ * arguments in FastLED, so each usable C3 pin gets its controller on first
+ * use; later configs reassign it with setLeds() instead of adding another.
+ */
+#pragma once
+
+#include <FastLED.h>
+#include "LedOutput.h"
+
+#define LED_PIN_COUNT 22     // GPIO 0-21 on the C3
+
+class FastLedOutput : public LedOutput {
+public:
+    /**
+     * The pixel buffer the strips point into (re-attach after it moves).
+     */
+    void attach(CRGB* pixels) { _pixels = pixels; }
+
+    bool begin(const std::vector<LedStrip>& strips) override {
+        // 1. Pins of the previous layout stay registered but send nothing
+        for (uint8_t pin = 0; pin < LED_PIN_COUNT; pin++) {
+            if (_controllers[pin]) _controllers[pin]->setLeds(_pixels, 0);
+        }
+
+        // 2. Point each strip at its range of the buffer
+        bool ok = true;
+        for (const LedStrip& s : strips) {
+            CLEDController* c = controllerFor(s.pin);
+            if (!c) {
+                Serial.printf("ERR: GPIO %u cannot drive LEDs. Strip skipped.\n", s.pin);
+                ok = false;
+                continue;
+            }
+            c->setLeds(_pixels + s.first, s.count);
+        }
+        return ok;
+    }
+
+    /**
+     * Every registered controller in order, like FastLED.show(), but
+     * without its per-frame power estimate (see PowerScale.h).
+     */
+    void show(uint8_t brightness) override {
+        for (CLEDController* c = CLEDController::head(); c; c = c->next()) c->showLeds(brightness);
+    }
+
+private:
+    CRGB* _pixels = nullptr;
+    CLEDController* _controllers[LED_PIN_COUNT] = { nullptr };
+
+    template <uint8_t PIN>
+    CLEDController* add() {
+        return &FastLED.addLeds<WS2812B, PIN, GRB>(_pixels, 0).setCorrection(TypicalLEDStrip);
+    }
+
+    /**
+     * Free pins only: 5/6 are the OLED, 8 the status LED, 11-17 the flash
+     * and 18/19 USB.
+     */
+    CLEDController* controllerFor(uint8_t pin) {
+        if (pin >= LED_PIN_COUNT) return nullptr;
+        if (_controllers[pin]) return _controllers[pin];
+        CLEDController* c = nullptr;
+        switch (pin) {
+            case 0:  c = add<0>();  break;
+            case 1:  c = add<1>();  break;
+            case 2:  c = add<2>();  break;
+            case 3:  c = add<3>();  break;
+            case 4:  c = add<4>();  break;
+            case 7:  c = add<7>();  break;
+            case 9:  c = add<9>();  break;
+            case 10: c = add<10>(); break;
+            case 20: c = add<20>(); break;
+            case 21: c = add<21>(); break;
+            default: break;
+        }
+        _controllers[pin] = c;
+        return c;
+    }
+};
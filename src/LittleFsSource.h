@@ -0,0 +1,74 @@
+/**
+ * LittleFS backends for the ShowEngine byte interfaces.
+ */
+#pragma once
+
+#include <LittleFS.h>
+#include "ByteSource.h"
+
+/**
+ * Show file on LittleFS. Seeks are skipped when the read continues where
+ * the previous one ended (sequential playback of uncompressed shows).
+ */
+class LittleFsSource : public ByteSource {
+public:
+    bool open(const String& path) {
+        close();
+        _file = LittleFS.open(path, "r");
+        _pos = 0;
+        return (bool)_file;
+    }
+    void close() {
+        if (_file) _file.close();
+        _file = File(); // The most important line for ESP32-C3 stability
+    }
+    explicit operator bool() { return (bool)_file; }
+
+    uint32_t size() override { return _file ? _file.size() : 0; }
+    size_t readAt(uint32_t offset, uint8_t* dst, size_t len) override {
+        if (!_file) return 0;
+        if (offset != _pos) {
+            uint32_t t0 = micros();
+            bool ok = _file.seek(offset);
+            _seekUs += micros() - t0;
+            if (!ok) return 0;
+        }
+        size_t n = _file.read(dst, len);
+        _pos = offset + n;
+        return n;
+    }
+
+    // Time spent seeking since the last call (us), for the pipeline metrics
+    uint32_t takeSeekUs() {
+        uint32_t us = _seekUs;
+        _seekUs = 0;
+        return us;
+    }
+
+private:
+    File _file;
+    uint32_t _pos = 0;
+    uint32_t _seekUs = 0;
+};
+
+/**
+ * Output file on LittleFS.
+ */
+class LittleFsSink : public ByteSink {
+public:
+    bool open(const String& path) {
+        close();
+        _file = LittleFS.open(path, "w");
+        return (bool)_file;
+    }
+    void close() {
+        if (_file) _file.close();
+        _file = File();
+    }
+
+    size_t write(const uint8_t* data, size_t len) override { return _file.write(data, len); }
+    bool seek(uint32_t offset) override { return _file.seek(offset); }
+
+private:
+    File _file;
+};
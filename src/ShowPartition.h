@@ -0,0 +1,96 @@
+/**
+ * Raw flash show slot (see ShowSlot.h): partition access for the firmware.
+ * Only present with partitions_showslot.csv; begin() returns false otherwise.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "ByteSource.h"
+#include "ShowSlot.h"
+
+#define SLOT_PARTITION_NAME    "showslot"
+#define SLOT_PARTITION_SUBTYPE 0x40      // Custom data subtype, see partitions_showslot.csv
+#define SLOT_SECTOR            4096      // Flash erase unit
+
+class ShowPartition {
+public:
+    /**
+     * Finds the partition and maps it. Call once at boot.
+     */
+    bool begin() {
+        _part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)SLOT_PARTITION_SUBTYPE,
+                                         SLOT_PARTITION_NAME);
+        return _part && map();
+    }
+
+    bool available() const { return _part != nullptr; }
+    uint32_t capacity() const { return _part ? _part->size : 0; }
+    bool valid() const { return _valid; }
+    const ShowSlotHeader& header() const { return _header; }
+
+    /**
+     * The stored show as a memory-mapped source (empty if the slot is not valid).
+     */
+    MemorySource& source() { return _source; }
+
+    /**
+     * True if the slot holds this show file in the given version.
+     */
+    bool holds(const String& show, uint32_t fingerprint) const {
+        return _valid && show == _header.name && fingerprint == _header.fingerprint;
+    }
+
+    /**
+     * Invalidates the slot and erases room for 'length' show bytes.
+     * The mapping is dropped until commit(), so nothing plays from it meanwhile.
+     */
+    bool beginWrite(uint32_t length) {
+        if (!_part || length == 0 || length > capacity() - SLOT_HEADER_SIZE) return false;
+        unmap();
+        uint32_t erase = (SLOT_HEADER_SIZE + length + SLOT_SECTOR - 1) & ~(SLOT_SECTOR - 1);
+        return esp_partition_erase_range(_part, 0, erase) == ESP_OK;
+    }
+
+    /**
+     * Writes show bytes at 'offset' (relative to the show start).
+     */
+    bool write(uint32_t offset, const uint8_t* data, size_t len) {
+        return esp_partition_write(_part, SLOT_HEADER_SIZE + offset, data, len) == ESP_OK;
+    }
+
+    /**
+     * Writes the header last and maps the new show.
+     */
+    bool commit(const ShowSlotHeader& header) {
+        uint8_t raw[SLOT_HEADER_SIZE];
+        encodeSlotHeader(header, raw);
+        bool ok = esp_partition_write(_part, 0, raw, sizeof(raw)) == ESP_OK;
+        return map() && ok;
+    }
+
+private:
+    bool map() {
+        unmap();
+        const void* ptr = nullptr;
+        if (esp_partition_mmap(_part, 0, _part->size, SPI_FLASH_MMAP_DATA, &ptr, &_handle) != ESP_OK) return false;
+        _base = (const uint8_t*)ptr;
+        _valid = decodeSlotHeader(_base, _part->size, _header);
+        if (_valid) _source.assign(_base + SLOT_HEADER_SIZE, _header.length);
+        return true;
+    }
+
+    void unmap() {
+        if (_base) spi_flash_munmap(_handle);
+        _base = nullptr;
+        _valid = false;
+        _source.assign(nullptr, 0);
+    }
+
+    const esp_partition_t* _part = nullptr;
+    spi_flash_mmap_handle_t _handle = 0;
+    const uint8_t* _base = nullptr;
+    bool _valid = false;
+    ShowSlotHeader _header;
+    MemorySource _source;
+};
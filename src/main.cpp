@@ -25,6 +25,26 @@
 #include <ElegantOTA.h>
 #include <ESPmDNS.h>
 #include <ArduinoJson.h>
+#include <AsyncUDP.h>
+#include <algorithm>
+#include <atomic>
+#include "FseqReader.h"     // ShowEngine (lib/ShowEngine): formats, mapping, timing
+#include "ChannelMapper.h"
+#include "DeltaCodec.h"
+#include "ShowCompiler.h"
+#include "FrameClock.h"
+#include "TimeSync.h"
+#include "ClockBeacon.h"
+#include "ChannelAnalyzer.h"
+#include "FileIndex.h"
+#include "LedOutput.h"
+#include "PowerScale.h"
+#include "PipelineMetrics.h"
+#include "FrameRing.h"
+#include "Platform.h"
+#include "LittleFsSource.h"
+#include "ShowPartition.h"
+#include "FastLedOutput.h"
 
 // --- Project definitions ---
 #define PROJECT_VERSION "1.0.1"
@@ -36,35 +56,147 @@ const char* password = "mys3xyls";
 
 // --- Hardware Pins ---
 #define STATUS_LED 8      // Onboard LED (standard for many C3 boards)
-#define DATA_PIN   2      // Fixed Data Pin (Right side of ESP32-C3 SuperMini)
+#define DATA_PIN   2      // Default Data Pin when a config has no "outputs" (Right side of ESP32-C3 SuperMini)
 #define OLED_SCL   6      // I2C Clock
 #define OLED_SDA   5      // I2C Data
 
 // --- LED & Playback Settings ---
-#define MAX_LEDS   100    // Buffer size for LED array
-CRGB leds[MAX_LEDS];
+#define MAX_LEDS   1024   // Config limit; the buffers are sized by loadConfig() (8 bytes per LED)
+std::vector<CRGB> ledBuffer;
+CRGB* leds = nullptr;     // ledBuffer.data()
+uint16_t ledCount = 0;
+FastLedOutput ledOutput;
 
 // --- Global State Variables ---
-bool showRunning      = false;
+std::atomic<bool> showRunning{false};  // Render task plays frames while set
+std::atomic<bool> showEnded{false};    // Render task finished or failed, loop() cleans up
 bool triggerCountdown = false; // Signals the loop to start or wait
+std::atomic<bool> cancelRequested{false}; // /cancel: loop() stops the show and closes its files
+std::atomic<bool> selectRequested{false}; // POST show=: loop() opens the new selection
 bool scanActive       = false; // If true, Analyzer Mode is used
 bool isBusy           = false; // Prevents overlapping FS operations
 bool configValid = false;
 
 // --- Timing & Sync Variables ---
 unsigned long showStartEpoch      = 0; // Target UTC epoch (0 = Instant Start)
-unsigned long showStartTimeMillis = 0; // Reference point for frame timing
-uint32_t currentFrame             = 0; // Global frame tracker
-uint16_t stepTimeMs               = 50; // Default frame duration (parsed from FSEQ)
+FrameClock frameClock;                 // Absolute frame deadlines + lateness histogram
+#define FRAME_SPIN_US 100              // Busy-wait for deadlines closer than this (us)
+esp_timer_handle_t renderWake = nullptr;   // One-shot: wakes the render task FRAME_SPIN_US before a deadline
+#define START_LEAD_US 1000000          // Open + prefill this long before a scheduled start
+#define JOIN_LEAD_US  400000           // Late join: seek + prefill budget before the first frame
+uint64_t joinRequestUs = 0;            // Late join in progress (render task reports and clears)
+uint32_t lastJoinFrame = 0;            // Last late join: first frame played
+uint32_t lastJoinTtffUs = 0;           //   and time from the request to that frame
+TimeSyncResult lastTimeSync;           // Last applied browser sync
+TimeSyncResult lastSyncCheck;          // Residual measured after it (apply=0)
+
+// --- Task Priorities (loop() runs at 1, AsyncTCP at 3) ---
+#define RENDER_TASK_PRIORITY 4         // Above AsyncTCP: web traffic cannot delay a frame
+#define READER_TASK_PRIORITY 2         // Above loop(), below AsyncTCP
 
 // --- File & Storage Variables ---
-File fseqFile;
-uint32_t realChannelsInFile = 0; 
-uint32_t channelCount    = 0;
-uint32_t frameCount      = 0;
-uint16_t fseqDataOffset = 0;   // Default to 32, but will be updated by header read
+LittleFsSource showSources[2];                 // Active show and the pre-opened next playlist entry
+FseqReader showReaders[2];
+LittleFsSource* showSource = &showSources[0];  // Open show file (FSEQ, .lsq or sidecar)
+FseqReader* fseq = &showReaders[0];             // Header facts and frame decoder for showSource
+LittleFsSource* nextSource = &showSources[1];  // Playlist: swapped with the active pair at the boundary
+FseqReader* nextFseq = &showReaders[1];
 uint8_t globalMax[512];        // Peak value storage for Channel Analyzer
-uint8_t frameData[1024];
+
+// --- Raw Flash Show Slot (partitions_showslot.csv) ---
+ShowPartition showSlot;
+String pendingSlotWrite = "";  // Show waiting to be copied into the slot in loop()
+bool playingSlot = false;      // Active show plays from mapped flash
+bool zeroCopy    = false;      //   and its frames go to the LEDs in place (no reader, no copy)
+
+// --- Native Delta/RLE Show Codec (.lsq) ---
+#define CONVERSION_QUEUE 8                     // Uploads waiting at once (e.g. stored during a show)
+std::vector<String> pendingConversions;        // Uploaded FSEQs waiting for conversion in loop()
+SemaphoreHandle_t conversionMutex = nullptr;   // Upload handler adds, loop() takes
+String pendingAnalysis = "";      // Show waiting for the offline channel analyzer in loop()
+
+// --- Frame Prefetch Ring ---
+#ifndef FRAME_RING_DEPTH
+#define FRAME_RING_DEPTH 8  // Frames read ahead of the frame clock (1 KB each)
+#endif
+
+/**
+ * Single-producer/single-consumer ring between the reader task (producer)
+ * and playFrame() (consumer). head and tail only ever grow; each side writes
+ * its own index, so no lock is needed.
+ */
+FrameSlot frameRing[FRAME_RING_DEPTH];
+std::atomic<uint32_t> ringHead{0};        // Next slot to fill (reader task only)
+std::atomic<uint32_t> ringTail{0};        // Next slot to play (render path only)
+std::atomic<uint32_t> ringWanted{0};      // Frame the render path asks for next
+std::atomic<bool> prefetchActive{false};  // Reader may touch the show file
+std::atomic<bool> readerBusy{false};      // Reader is inside a file operation
+std::atomic<bool> readerFailed{false};    // Read/decompress error, show must end
+uint32_t nextReadFrame = 0;               // Reader task only
+uint32_t ringUnderruns = 0;               // Render path found the ring empty
+uint32_t ringDropped   = 0;               // Pre-read frames skipped by lag compensation
+uint32_t ringMinFill   = FRAME_RING_DEPTH;
+TaskHandle_t readerTaskHandle = nullptr;
+TaskHandle_t renderTaskHandle = nullptr;
+std::atomic<bool> renderBusy{false};      // Render task is inside playFrame()
+
+// --- Temporal Interpolation (render_hz in the config) ---
+#define BLEND_MAX_SUBS 16   // Outputs per show frame at most
+
+uint8_t blendSubs = 1;      // Outputs per show frame (1: interpolation off)
+bool heldFrame = false;     // Last played slot stays at the ring tail as the blend source
+uint32_t blendSkipped = 0;  // Interpolation ticks without the next frame at hand
+
+// --- Playlist (gapless show sequence, see prepareNextShow / switchToNextShow) ---
+#define PLAYLIST_MAX 16
+struct PlaylistEntry {
+    String show;
+    String config;
+};
+std::vector<PlaylistEntry> playlist;
+uint8_t playlistPos = 0;                        // Entry selected or playing
+bool nextFailed = false;                        // Next entry cannot follow gaplessly: restart at the end
+std::atomic<bool> nextReady{false};             // Next entry opened and mapped (loop() -> render task)
+std::atomic<bool> showSwitched{false};          // Render task took over the next entry, loop() follows up
+std::atomic<FseqReader*> readerNext{nullptr};   // Reader continues here after the last frame
+FseqReader* readerFseq = nullptr;               // Show the reader task reads (reader task only)
+std::atomic<uint8_t> readerSegment{0};          // Playlist shows the reader has moved on
+std::atomic<uint8_t> renderSegment{0};          //   and the render path
+std::vector<uint16_t> nextLedSrc;               // Next entry's LED map, power scales and settings,
+std::vector<uint8_t>  nextLedColor;             //   swapped in at the boundary
+std::vector<uint8_t>  nextPowerScales;
+uint8_t nextBlendSubs = 1;
+bool nextSidecar = false;
+uint32_t nextShowId = 0;
+uint64_t transitionUs = 0;                      // Boundary of a switch: the render task measures the gap
+uint32_t lastGapUs = 0;                         // Last switch: first frame of the new show after the boundary
+uint32_t maxGapUs = 0;
+uint16_t playlistSwitches = 0;
+
+// --- Pipeline Metrics (GET /metrics in Prometheus text format, see PipelineMetrics.h) ---
+#define METRICS_LATE_US 1000          // Frames released later than this after their deadline count as late
+PipelineMetrics pipelineMetrics;      // Stage times since boot
+StageHistogram frameLateness;         // Release time - deadline of every played frame (render task)
+uint32_t framesPlayed       = 0;      // Counters since boot (render task)
+uint32_t framesLate         = 0;
+uint32_t framesSkipped      = 0;      // Dropped by lag compensation
+uint32_t ringDroppedTotal   = 0;
+uint32_t ringUnderrunsTotal = 0;
+uint64_t renderSpinUsTotal  = 0;      // Render task CPU time spent spinning for deadlines
+
+// --- Multi-Car Sync (leader/follower UDP beacons, see ClockBeacon.h) ---
+enum SyncRole : uint8_t { SYNC_OFF, SYNC_LEADER, SYNC_FOLLOWER };
+SyncRole syncRole = SYNC_OFF;
+AsyncUDP beaconUdp;
+struct BeaconRx {
+    ClockBeacon beacon;
+    uint64_t rxUs;                        // engineMicros64() on arrival
+};
+QueueHandle_t beaconQueue = nullptr;      // UDP callback -> render task
+ClockFollower clockFollower;              // Render task only
+uint32_t showId = 0;                      // Same show on every car, see showIdFor()
+uint32_t selectedShowId = 0;              // showId of the selected (not yet playing) show
+bool followerJoinArmed = false;           // Follower joins a running leader (set by the UI)
 
 // --- OLED Display Setup ---
 U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE, OLED_SCL, OLED_SDA);
@@ -75,40 +207,106 @@ const int yOffset = 12;
 WiFiUDP ntpUDP;
 NTPClient timeClient(ntpUDP, "pool.ntp.org", 3600, 60000); // UTC+1 (CET)
 AsyncWebServer server(80);
+AsyncEventSource events("/events");   // Live status push (Server-Sent Events)
 
 /**
  * Hardware Config Structure
  */
-struct LedMapping {
-  uint16_t channel;
-};
-
 struct Config {
   String name = "Default";
   uint16_t channel_offset = 0;
   uint8_t max_brightness = 128;
   uint16_t max_milliamps = 500;
+  uint16_t read_gap = FSEQ_READ_GAP;      // Unused channels bridged between range reads
+  uint16_t render_hz = 0;                 // Interpolated output rate (0: one output per show frame)
+  uint32_t wire_us = 0;                   // Transmit time of all strips per output (see outputWireUs)
+  std::vector<LedStrip> outputs;          // Data pins and their LED ranges
+  ColorProfile colors;                    // Built-in color classes plus the config's "colors"
   std::vector<LedMapping> leds;
+  std::vector<ChannelRange> readRanges;   // Channels the LEDs use, merged (see coalesceChannels)
 };
 
 Config currentConfig;
 
+// Compiled LED map (see ChannelMapper.h), rebuilt by loadConfig()
+std::vector<uint16_t> ledSrc;
+std::vector<uint8_t>  ledColor;
+std::vector<ColorLut> colorLuts;   // One per class of currentConfig.colors
+LedMapTable ledMap = { nullptr, nullptr, nullptr, 0 };
+
 // --- Functional Prototypes (to be implemented) ---
-void startShowSequence();
+void startShowSequence(uint64_t startUs = 0);
+void startFramePrefetch(uint32_t firstFrame = 0);
 void stopShowAndCleanup();
+void followPlaylistSwitch();
+bool playlistHasNext();
+void selectPlaylistEntry(uint8_t pos);
 bool readFseqHeader();
 bool playFrame(uint32_t frameIdx);
 void handleTeslaApp(AsyncWebServerRequest *request);
 void handleDelete(AsyncWebServerRequest *request);
+void handleUploadDone(AsyncWebServerRequest *request);
+void handleAnalyze(AsyncWebServerRequest *request);
+void handleAnalysis(AsyncWebServerRequest *request);
+void handleSlot(AsyncWebServerRequest *request);
+void handlePlaylist(AsyncWebServerRequest *request);
+String analysisPath(const String& show);
+void handleUploadChunk(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final);
+void handleApiState(AsyncWebServerRequest *request);
+void handleMetrics(AsyncWebServerRequest *request);
+void handleTime(AsyncWebServerRequest *request);
+void handleTimeSync(AsyncWebServerRequest *request);
+int64_t epochMicros();
+void setEpochMicros(int64_t us);
+uint32_t sourceFingerprint(const String& path, bool wholeFile);
 
 // --- Global File References (Default placeholders) ---
 String currentConfigFile    = "None selected"; 
 String currentShow          = "None selected";
 String lastUploadedFilename = "";
 
-// Globale Cache-Variablen
-String cachedFseqOptions = "";
-String cachedConfigOptions = "";
+// --- File Index (see FileIndex.h, served as JSON by /api/state) ---
+#define FILE_INDEX_PATH "/files.lsi"
+FileIndex fileIndex;
+SemaphoreHandle_t fileIndexMutex = nullptr;   // loop() and the web handlers both change the index
+bool indexIncomplete = false;   // Shows stored during playback: headers parsed once idle
+size_t cachedFsUsed  = 0;
+size_t cachedFsTotal = 0;
+
+// --- Web UI Asset ---
+#define UI_ASSET "/index.html.gz"   // Built from web/index.html by gzip_ui.py
+String uiEtag = "";                 // Empty: asset missing, fallback page is served
+
+// --- Upload Pipeline ---
+#define UPLOAD_TMP   "/upload.part"   // Renamed to the final name once complete and valid
+#define UPLOAD_BLOCK 4096             // LittleFS block size: chunks are coalesced to this
+#define UPLOAD_IDLE_MS 10000          // An owner without chunks for this long has dropped out
+struct UploadJob {
+    AsyncWebServerRequest* owner = nullptr;  // One upload at a time: buffer and temp file are its own
+    uint32_t lastChunkMs = 0;
+    uint8_t* buf = nullptr;           // UPLOAD_BLOCK coalescing buffer
+    size_t fill = 0;
+    size_t total = 0;
+    uint32_t startMs = 0;
+    bool isShow = false;              // .fseq/.lsq: header checked from the first bytes
+    bool headerChecked = false;
+    AsyncWebServerRequest* rejected = nullptr;  // Error page already sent to this request
+};
+UploadJob upload;
+
+// --- Live Status Push ---
+#define LIVE_STATUS_RUN_MS  250     // Progress updates during a show
+#define LIVE_STATUS_WAIT_MS 1000    // Countdown ticks
+volatile bool uiStateChanged = false;  // Files/selection changed: clients refetch /api/state
+volatile bool liveStatusForce = false; // New client connected: push status now
+
+// --- Show Compiler (config-specific sidecar) ---
+bool compileRequested = false;     // Set by UI/upload, executed in loop() when idle
+bool playingSidecar   = false;     // Active show streams from a sidecar
+
+// --- Power Limit (per-frame brightness sidecar, see PowerScale.h) ---
+#define POWER_MAX_FRAMES 16384            // Scales kept in RAM (5.5 min at 20 ms); longer shows are estimated
+std::vector<uint8_t> powerScales;         // Brightness per frame of the active show (empty: estimated per frame)
 
 /**
  * Returns a formatted string with storage statistics.
@@ -145,27 +343,106 @@ String getSystemStatus() {
 }
 
 /**
- * Parses a JSON config file to return a short HTML-formatted summary.
+ * Holds the file index mutex for one scope. Not recursive: no helper that
+ * takes it may be called while it is held.
+ */
+struct FileIndexLock {
+  FileIndexLock() { xSemaphoreTake(fileIndexMutex, portMAX_DELAY); }
+  ~FileIndexLock() { xSemaphoreGive(fileIndexMutex); }
+};
+
+bool isIndexed(const String& path) {
+    FileIndexLock lock;
+    return fileIndex.find(path.c_str()) != nullptr;
+}
+
+void unindexFile(const String& path) {
+    FileIndexLock lock;
+    fileIndex.remove(path.c_str());
+}
+
+/**
+ * Short HTML-formatted summary of a config file, from its index record.
  * Used to display hardware details in the Web UI.
  */
 String getConfigSummary(String filename) {
-    // Ensure filename has leading slash
-    if (!filename.startsWith("/")) filename = "/" + filename;
-    
-    File file = LittleFS.open(filename, "r");
-    if (!file) return "Error: Could not open config file";
+    FileIndexLock lock;
+    const FileRecord* rec = fileIndex.find(filename.c_str());
+    if (!rec) return "Error: Could not open config file";
+    if (rec->leds == 0 && rec->label[0] == 0) return "Error: Invalid JSON structure";
 
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, file);
-    file.close();
+    return "<b>" + String(rec->label) + "</b>: " + String(rec->leds) + " LEDs mapped";
+}
 
-    if (error) return "Error: Invalid JSON structure";
+/**
+ * Sizes the LED buffer and the compiled map for 'count' LEDs and points
+ * the output strips at the new buffer. Only while no show plays.
+ */
+void allocateLeds(uint16_t count) {
+    ledBuffer.assign(count, CRGB::Black);
+    ledBuffer.shrink_to_fit();
+    ledSrc.assign(count, 0);
+    ledColor.assign(count, COLOR_OFF);
+    leds = ledBuffer.data();
+    ledCount = count;
+    ledMap = { ledSrc.data(), ledColor.data(), colorLuts.data(), count };
+    ledOutput.attach(leds);
+}
 
-    String name   = doc["name"] | "Unknown Device";
-    int ledsCount = doc["leds"].size();
+/**
+ * Reads an [r, g, b] array into 'rgb'; missing entries keep their value.
+ */
+void readRgb(JsonVariant v, uint8_t* rgb) {
+    JsonArray a = v.as<JsonArray>();
+    for (size_t i = 0; i < 3 && i < a.size(); i++) rgb[i] = a[i] | rgb[i];
+}
 
-    // Note: data_pin is now fixed to GPIO 2 in code for stability.
-    return "<b>" + name + "</b>: " + String(ledsCount) + " LEDs mapped (Pin 2)";
+/**
+ * Adds a rule per entry of a "channels" or "leds" list: a number or a
+ * [first, last] range.
+ */
+void addColorRules(JsonVariant list, uint8_t colorClass, bool byLed, ColorProfile& profile) {
+    for (JsonVariant e : list.as<JsonArray>()) {
+        ColorRule rule = { colorClass, byLed, 0, 0 };
+        if (e.is<JsonArray>()) {
+            rule.first = e[0] | 0;
+            rule.last = e[1] | rule.first;
+        } else {
+            rule.first = rule.last = e | 0;
+        }
+        profile.rules.push_back(rule);
+    }
+}
+
+/**
+ * Reads one entry of "colors": a class (tint, gamma, min, max) and the
+ * channels and LEDs it applies to. A built-in name ("amber", "red",
+ * "blue", "white") retunes that class for every LED that uses it.
+ */
+void parseColorClass(JsonObject o, ColorProfile& profile) {
+    const char* name = o["name"] | "";
+    int id = name[0] ? findColorClass(profile, name) : -1;
+    if (id == COLOR_OFF) {
+        Serial.println(F("WARN: Color class 'off' cannot be changed."));
+        return;
+    }
+    if (id < 0) {
+        if (profile.classes.size() >= MAX_COLOR_CLASSES) {
+            Serial.printf("WARN: Color class '%s' dropped, at most %d classes.\n", name, MAX_COLOR_CLASSES);
+            return;
+        }
+        id = profile.classes.size();
+        profile.classes.push_back(ColorClass());
+        snprintf(profile.classes[id].name, sizeof(profile.classes[id].name), "%s", name);
+    }
+
+    ColorClass& c = profile.classes[id];
+    readRgb(o["tint"], c.tint);
+    c.gamma = o["gamma"] | c.gamma;
+    readRgb(o["min"], c.min);
+    readRgb(o["max"], c.max);
+    addColorRules(o["channels"], id, false, profile);
+    addColorRules(o["leds"], id, true, profile);
 }
 
 /**
@@ -177,10 +454,8 @@ void applyPowerSettings() {
   // Default to 128 if not specified in JSON
   FastLED.setBrightness(currentConfig.max_brightness);
 
-  // Apply power management
-  // This calculates the power draw and dims LEDs if they exceed the limit
-  // Default to 500mA for safety
-  FastLED.setMaxPowerInVoltsAndMilliamps(5, currentConfig.max_milliamps);
+  // Power management: max_milliamps (default 500mA for safety) is applied per frame
+  // through frameBrightness(), from the power sidecar or an estimate of the pixels
 }
 
 /**
@@ -216,6 +491,19 @@ bool loadConfig(const String& filename) {
     currentConfig.channel_offset = doc["channel_offset"] | 0;
     currentConfig.max_brightness = doc["max_brightness"] | 128;
     currentConfig.max_milliamps = doc["max_milliamps"] | 500;
+    currentConfig.read_gap = doc["read_gap"] | FSEQ_READ_GAP;
+    currentConfig.render_hz = doc["render_hz"] | 0;
+
+    currentConfig.colors = defaultColorProfile();
+    for (JsonObject o : doc["colors"].as<JsonArray>()) parseColorClass(o, currentConfig.colors);
+
+    currentConfig.outputs.clear();
+    for (JsonObject o : doc["outputs"].as<JsonArray>()) {
+        LedStrip strip;
+        strip.pin = o["pin"] | DATA_PIN;
+        strip.count = o["count"] | 0;
+        currentConfig.outputs.push_back(strip);
+    }
 
     // 5. LED Mapping mit Bounds-Checking
     currentConfig.leds.clear();
@@ -246,17 +534,50 @@ bool loadConfig(const String& filename) {
     
     // Speicherbereinigung für den ESP32-C3 Heap
     currentConfig.leds.shrink_to_fit();
+    buildColorLuts(currentConfig.colors, colorLuts);
+    allocateLeds(currentConfig.leds.size());
+    compileLedMap(currentConfig.leds, ledMap, false, &currentConfig.colors);
+    if (currentConfig.colors.classes.size() > COLOR_BUILTIN_COUNT || !currentConfig.colors.rules.empty()) {
+        Serial.printf("Color profile: %u classes, %u rules\n", (unsigned)currentConfig.colors.classes.size(),
+                      (unsigned)currentConfig.colors.rules.size());
+    }
+
+    // Output layout: LEDs go to the strips in order, two strips transmit at a time
+    if (currentConfig.outputs.size() > LED_MAX_OUTPUTS) {
+        Serial.printf("WARN: JSON defines %u outputs, at most %d are used.\n",
+                      (unsigned)currentConfig.outputs.size(), LED_MAX_OUTPUTS);
+    }
+    if (!layoutStrips(currentConfig.outputs, ledCount, DATA_PIN)) {
+        Serial.println(F("WARN: Outputs hold fewer LEDs than the config maps. The rest stays dark."));
+    }
+    currentConfig.wire_us = outputWireUs(currentConfig.outputs);
+    for (const LedStrip& s : currentConfig.outputs) {
+        if (s.count == 0) continue;
+        Serial.printf("Output: GPIO %u, LEDs %u-%u, %u us\n", s.pin, s.first, s.first + s.count - 1,
+                      stripWireUs(s.count));
+    }
+    Serial.printf("Output plan: %u us per update on %d transmitters\n", currentConfig.wire_us, LED_RMT_CHANNELS);
+
+    // Read plan: only these channel ranges are fetched from uncompressed shows
+    std::vector<uint16_t> used;
+    used.reserve(currentConfig.leds.size());
+    for (const LedMapping& m : currentConfig.leds) used.push_back(m.channel);
+    currentConfig.readRanges = coalesceChannels(used, currentConfig.read_gap);
+    uint32_t planBytes = 0;
+    for (const ChannelRange& r : currentConfig.readRanges) planBytes += r.count;
+    Serial.printf("Read plan: %u ranges, %u bytes per frame (gap %u)\n",
+                  (unsigned)currentConfig.readRanges.size(), planBytes, currentConfig.read_gap);
 
     // 6. Hardware Re-Initialisierung
     int numLeds = currentConfig.leds.size();
     if (numLeds > 0) {
-        // FastLED.addLeds kann mehrfach aufgerufen werden; es aktualisiert den internen Pointer.
-        FastLED.addLeds<WS2812B, DATA_PIN, GRB>(leds, numLeds).setCorrection(TypicalLEDStrip); 
+        // Pins keep their FastLED controller; only the LED ranges change
+        ledOutput.begin(currentConfig.outputs);
         
         applyPowerSettings(); // Wendet Helligkeit und mA-Limit an
         
         FastLED.clear();
-        FastLED.show();
+        ledOutput.show(0);
     }
     
     configValid = (numLeds > 0); 
@@ -291,234 +612,1567 @@ void showIP() {
 
   u8g2.drawStr(xOffset, yOffset + 44, "mys3xy.local");
   
-  u8g2.sendBuffer();
-  delay(6000);  // Show for 6 seconds
+  u8g2.sendBuffer(); // Stays until the next status message (no blocking hold)
 }
 
 /**
- * Scans LittleFS and caches HTML options for the Web UI.
- * Prevents file system lag during show playback and stabilizes the heap.
+ * Files the index lists: everything but the UI asset, the index itself
+ * and temporary files of unfinished jobs.
  */
-void refreshFileCache() {
-    if (showRunning) return; 
-    
-    cachedFseqOptions = "";
-    cachedConfigOptions = "";
-    
+bool isIndexedFile(const String& path) {
+    return path != UI_ASSET && path != FILE_INDEX_PATH && !path.endsWith(".tmp") && !path.endsWith(".part");
+}
+
+/**
+ * Adds or refreshes the index record of one file: size, kind and the
+ * parsed show header or config summary. Does not save the index.
+ * During a show only size and kind are taken (no second show decoder
+ * next to the playing one); loop() completes the record later.
+ */
+void indexFile(const String& path) {
+    if (!isIndexedFile(path)) return;
+    File f = LittleFS.open(path, "r");
+    if (!f) {
+        unindexFile(path);
+        return;
+    }
+
+    FileRecord rec;
+    strncpy(rec.name, path.c_str() + 1, FILE_INDEX_NAME - 1);
+    rec.size = f.size();
+    rec.kind = fileKindOf(rec.name);
+
+    if (rec.kind == FILE_KIND_CONFIG) {
+        JsonDocument doc;
+        if (!deserializeJson(doc, f)) {
+            strncpy(rec.label, doc["name"] | "Unknown Device", FILE_INDEX_LABEL - 1);
+            rec.leds = doc["leds"].size();
+        }
+    }
+    f.close();
+
+    if (rec.kind == FILE_KIND_SHOW && showRunning) {
+        indexIncomplete = true;
+    } else if (rec.kind == FILE_KIND_SHOW) {
+        LittleFsSource src;
+        FseqReader reader;
+        if (src.open(path) && reader.open(&src)) describeShow(rec, reader.info());
+    }
+    FileIndexLock lock;
+    fileIndex.put(rec);
+}
+
+/**
+ * Writes the index (atomically) and tells the UI clients.
+ */
+void saveFileIndex() {
+    LittleFsSink out;
+    bool ok = out.open("/files.tmp");
+    {
+        FileIndexLock lock;
+        ok = ok && fileIndex.save(out);
+    }
+    out.close();
+    if (!ok || !LittleFS.rename("/files.tmp", FILE_INDEX_PATH)) {
+        LittleFS.remove("/files.tmp");
+        Serial.println(F("ERR: Could not save the file index!"));
+    }
+    cachedFsUsed  = LittleFS.usedBytes();
+    cachedFsTotal = LittleFS.totalBytes();
+    uiStateChanged = true;
+}
+
+/**
+ * The only directory walk: builds the index from scratch when it is
+ * missing or damaged (first boot, new filesystem image).
+ */
+void rebuildFileIndex() {
+    unsigned long t0 = millis();
+    {
+        FileIndexLock lock;
+        fileIndex.clear();
+    }
+
+    std::vector<String> names;
     File root = LittleFS.open("/");
     if (!root || !root.isDirectory()) {
-        Serial.println(F("ERR: Could not open Root for caching!"));
+        Serial.println(F("ERR: Could not open Root for indexing!"));
         return;
     }
-
     File entry = root.openNextFile();
     while (entry) {
         String n = entry.name();
-        
-        // Path normalization: remove leading slash if present
-        if (n.startsWith("/")) n = n.substring(1);
-        
-        if (n.endsWith(".fseq")) {
-            // Mark the currently selected show in the dropdown
-            String selected = (("/" + n) == currentShow) ? " selected" : "";
-            cachedFseqOptions += "<option value='" + n + "'" + selected + ">" + n + "</option>";
-        } 
-        else if (n.startsWith("config_") && n.endsWith(".json")) {
-            // Mark the currently selected hardware config
-            String selected = (("/" + n) == currentConfigFile) ? " selected" : "";
-            cachedConfigOptions += "<option value='" + n + "'" + selected + ">" + n + "</option>";
-        }
-        
+        names.push_back(n.startsWith("/") ? n : "/" + n);
         entry.close();
         entry = root.openNextFile();
     }
     root.close();
-    Serial.println(F("UI File Cache updated."));
+
+    for (const String& n : names) indexFile(n);
+    saveFileIndex();
+    Serial.printf("File index rebuilt: %u files in %lu ms\n", (unsigned)fileIndex.records().size(), millis() - t0);
 }
 
 /**
- * Parses the FSEQ file header and updates OLED status.
- * Correctly extracts physical channel count to prevent READ ERRORs.
+ * Boot: reads the saved index (one small file) instead of walking and
+ * opening every stored file.
  */
-bool readFseqHeader() {
-    if (!fseqFile) return false;
-    uint8_t h[32]; 
-    fseqFile.seek(0);
-    if (fseqFile.read(h, 32) < 28) return false;
+void loadFileIndex() {
+    unsigned long t0 = millis();
+    LittleFsSource src;
+    if (!src.open(FILE_INDEX_PATH) || !fileIndex.load(src)) {
+        src.close();
+        Serial.println(F("WARN: File index missing or damaged. Rebuilding."));
+        rebuildFileIndex();
+        return;
+    }
+    cachedFsUsed  = LittleFS.usedBytes();
+    cachedFsTotal = LittleFS.totalBytes();
+    Serial.printf("File index loaded: %u files in %lu ms\n", (unsigned)fileIndex.records().size(), millis() - t0);
+}
 
-    // Verify Magic Cookie
-    if (h[0] != 'P' || h[1] != 'S' || h[2] != 'E' || h[3] != 'Q') return false;
+/**
+ * Hashes the gzipped UI asset into its ETag.
+ * Browsers revalidate with If-None-Match and get a 304 until the asset changes.
+ */
+void refreshUiEtag() {
+    uiEtag = "";
+    if (!LittleFS.exists(UI_ASSET)) {
+        Serial.println(F("WARN: " UI_ASSET " missing, serving fallback page. Run 'Upload Filesystem Image'."));
+        return;
+    }
+    char buf[11];
+    sprintf(buf, "\"%08x\"", (unsigned)sourceFingerprint(UI_ASSET, true));
+    uiEtag = buf;
+}
 
-    fseqDataOffset = (uint16_t)h[4] | ((uint16_t)h[5] << 8);
-    
-    // Physical channels (e.g., 200 in Simon's file)
-    realChannelsInFile = (uint32_t)h[10] | ((uint32_t)h[11] << 8) | 
-                         ((uint32_t)h[12] << 16) | ((uint32_t)h[13] << 24);
-                         
-    frameCount = (uint32_t)h[14] | ((uint32_t)h[15] << 8) | 
-                 ((uint32_t)h[16] << 16) | ((uint32_t)h[17] << 24);
+/**
+ * Closes the show file and frees the decoder buffers.
+ */
+void closeShowFile() {
+    fseq->close();
+    showSource->close();
+}
 
-    stepTimeMs = h[18] | (h[19] << 8);
+/**
+ * Playlist: closes the pre-opened next show, or after a switch the finished
+ * one. The reader must not be on it (stopped, or moved on to the new show).
+ */
+void closeNextShow() {
+    nextReady = false;
+    readerNext = nullptr;
+    nextFseq->close();
+    nextSource->close();
+    nextPowerScales.clear();
+    nextPowerScales.shrink_to_fit();
+}
 
-    // LOGICAL SYNC: This fixes your missing LEDs. 
-    // We treat the show as a 512-channel show so mapping 392, 164 etc. works perfectly.
-    channelCount = realChannelsInFile; // This will be 200
+/**
+ * Parses the header of the open show file and updates OLED status.
+ * Formats, sparse ranges and compression are handled by the FseqReader;
+ * this wrapper reports what it found on Serial and the OLED.
+ */
+bool readFseqHeader() {
+    if (!*showSource) return false;
+
+    if (!fseq->open(showSource)) {
+        Serial.printf("ERR: %s\n", fseq->lastError());
+        if (fseq->info().compression == FSEQ_COMPRESSION_ZSTD) showStatus("ZSTD: USE ZLIB");
+        return false;
+    }
+
+    const FseqInfo& info = fseq->info();
+    if (info.compression == FSEQ_COMPRESSION_ZLIB) {
+        Serial.printf("FSEQ V2 zlib: %u blocks indexed\n", info.blockCount);
+    }
+    if (info.rangeCount > 0) Serial.printf("FSEQ V2 sparse: %u ranges\n", info.rangeCount);
+    if (!info.mediaFile.empty()) Serial.printf("FSEQ media: %s\n", info.mediaFile.c_str());
+    if (info.frameCount < info.announcedFrames) {
+        Serial.printf("WARN: Header announces %u frames, file holds %u. Truncating.\n",
+                      info.announcedFrames, info.frameCount);
+    }
 
     // OLED Feedback (as per your original style)
     u8g2.clearBuffer();
     u8g2.setFont(u8g2_font_6x10_tr);
-    u8g2.setCursor(0, 20); u8g2.print("Ch: "); u8g2.print(realChannelsInFile);
-    u8g2.setCursor(0, 40); u8g2.print("Off: "); u8g2.print(fseqDataOffset);
+    u8g2.setCursor(0, 20); u8g2.print("Ch: "); u8g2.print(info.stride);
+    u8g2.setCursor(0, 40); u8g2.print("Off: "); u8g2.print(info.dataOffset);
     u8g2.sendBuffer();
+    return true;
+}
 
-    return (realChannelsInFile > 0);
+/**
+ * Reads one frame of the show the reader is on into a logical channel buffer.
+ * Runs in the reader task only; it is the sole user of the show file during a show.
+ */
+bool readFrameInto(uint32_t frameIdx, uint8_t* logical) {
+    if (!readerFseq->readFrame(frameIdx, logical)) {
+        Serial.printf("CRITICAL: %s at Frame %u\n", readerFseq->lastError(), frameIdx);
+        return false;
+    }
+    return true;
 }
 
 /**
- * FINAL RELEASE VERSION 1.0.0
- * Features: 512-Stride Emulation, Virtual File Looping, Channel Analyzer.
- * Solves the "Frame 2879" crash while maintaining perfect Tesla-sync.
+ * Background reader: keeps the ring filled with the frames following
+ * ringWanted, so LittleFS stalls are absorbed before they reach the LEDs.
+ * Playlist: after the last frame it goes on with the queued next show, so
+ * that show's first frames are in the ring before the current one ends.
  */
-bool playFrame(uint32_t frameIdx) {
-    if (!fseqFile || frameIdx >= frameCount) return false;
+void frameReaderTask(void* param) {
+    for (;;) {
+        // Announce the file access before checking the flag (see stopFramePrefetch)
+        readerBusy = true;
+        if (!prefetchActive || readerFailed) {
+            readerBusy = false;
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        uint32_t head = ringHead.load(std::memory_order_relaxed);
+        uint32_t tail = ringTail.load(std::memory_order_acquire);
+
+        // Lag compensation skips frames; the render path having left this show
+        // (running late) ends it. Being one show ahead of it is the normal case.
+        uint8_t segment = readerSegment.load(std::memory_order_relaxed);
+        uint8_t rendering = renderSegment.load(std::memory_order_acquire);
+        uint32_t wanted = ringWanted.load(std::memory_order_relaxed);
+        nextReadFrame = readerNextFrame(segment, rendering, nextReadFrame, wanted, readerFseq->info().frameCount);
+
+        // Playlist: this show is done, go on with the next one
+        if (nextReadFrame >= readerFseq->info().frameCount) {
+            FseqReader* next = readerNext.exchange(nullptr, std::memory_order_acquire);
+            if (next) {
+                readerFseq = next;
+                readerSegment.store(++segment, std::memory_order_release);
+                nextReadFrame = readerNextFrame(segment, rendering, 0, wanted, readerFseq->info().frameCount);
+            }
+        }
+
+        if (head - tail >= FRAME_RING_DEPTH || nextReadFrame >= readerFseq->info().frameCount) {
+            readerBusy = false;
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(readerFseq->info().stepTimeMs));
+            continue;
+        }
+
+        FrameSlot& slot = frameRing[head % FRAME_RING_DEPTH];
+        claimSlot(slot, segment);
+        uint32_t readStart = micros();
+        if (!readFrameInto(nextReadFrame, slot.data)) {
+            readerFailed = true;
+            continue;
+        }
+        uint32_t readUs = micros() - readStart;
+        uint32_t seekUs = min(readUs, showSources[readerFseq - showReaders].takeSeekUs());   // 0 from the flash slot
+        pipelineMetrics.add(STAGE_SEEK, seekUs);
+        pipelineMetrics.add(STAGE_READ, readUs - seekUs);
+        slot.frameIdx = nextReadFrame++;
+        ringHead.store(head + 1, std::memory_order_release);
+    }
+}
+
+/**
+ * Empties the ring and lets the reader start at 'firstFrame' of the open show
+ * (the readers seek via the block or keyframe index).
+ */
+void startFramePrefetch(uint32_t firstFrame) {
+    memset(frameRing, 0, sizeof(frameRing)); // Slots outside the remap stay black
+    ringHead = 0;
+    ringTail = 0;
+    heldFrame = false;
+    ringWanted = firstFrame;
+    nextReadFrame = firstFrame;
+    readerFseq = fseq;
+    readerNext = nullptr;
+    readerSegment = 0;
+    renderSegment = 0;
+    ringUnderruns = 0;
+    ringDropped = 0;
+    ringMinFill = FRAME_RING_DEPTH;
+    readerFailed = false;
+    prefetchActive = true;
+    xTaskNotifyGive(readerTaskHandle);
+}
+
+/**
+ * Stops the reader and waits until it has left the file, so the show file can be
+ * closed safely afterwards.
+ */
+void stopFramePrefetch() {
+    prefetchActive = false;
+    xTaskNotifyGive(readerTaskHandle);
+    while (readerBusy) vTaskDelay(1);
+}
+
+/**
+ * 32-bit FNV-1a hash, used for sidecar names and source fingerprints.
+ */
+uint32_t fnv1a(const uint8_t* data, size_t len, uint32_t hash = 2166136261u) {
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t fnv1a(const String& s) {
+    return fnv1a((const uint8_t*)s.c_str(), s.length());
+}
+
+/**
+ * Sidecar path for a show/config pair: "/<showHash><configHash>.lsc"
+ * (".lsp" for the power scales). Hashing keeps the name short enough for LittleFS.
+ */
+String sidecarPath(const String& show, const String& config, const char* ext = ".lsc") {
+    char buf[24];
+    sprintf(buf, "/%08x%08x%s", (unsigned)fnv1a(show), (unsigned)fnv1a(config), ext);
+    return String(buf);
+}
+
+/**
+ * Fingerprint of a source file: size, modification time and the first
+ * 64 bytes (for an FSEQ that covers the header). Configs are hashed whole.
+ */
+uint32_t sourceFingerprint(const String& path, bool wholeFile) {
+    File f = LittleFS.open(path, "r");
+    if (!f) return 0;
+
+    uint32_t meta[2] = { (uint32_t)f.size(), (uint32_t)f.getLastWrite() };
+    uint32_t hash = fnv1a((const uint8_t*)meta, sizeof(meta));
+
+    uint8_t buf[64];
+    size_t n;
+    while ((n = f.read(buf, sizeof(buf))) > 0) {
+        hash = fnv1a(buf, n, hash);
+        if (!wholeFile) break;
+    }
+    f.close();
+    return hash;
+}
+
+/**
+ * Removes every sidecar built from the given show or config file.
+ * Called on upload and delete; stale sidecars are also caught by their
+ * fingerprints, this just frees the space early.
+ */
+void removeSidecarsFor(const String& path) {
+    char hex[9];
+    sprintf(hex, "%08x", (unsigned)fnv1a(path));
+
+    std::vector<String> stale;
+    {
+        FileIndexLock lock;
+        for (const FileRecord& r : fileIndex.records()) {
+            String n = r.name;
+            if (r.kind == FILE_KIND_SIDECAR && (n.startsWith(hex) || n.substring(8, 16) == hex)) stale.push_back("/" + n);
+            else if (r.kind == FILE_KIND_REPORT && n.startsWith(hex)) stale.push_back("/" + n);
+        }
+    }
 
-    // 1. LOGICAL VS PHYSICAL STEERING
-    // We use 512 to match the Tesla Mapping, but the file only has ~2879 frames worth of data.
-    uint32_t logicalStride = 512;
-    uint32_t physicalMaxFrames = (fseqFile.size() - fseqDataOffset) / logicalStride;
+    for (const String& n : stale) {
+        LittleFS.remove(n);
+        unindexFile(n);
+        Serial.printf("Sidecar removed: %s\n", n.c_str());
+    }
+}
+
+/**
+ * Opens the current show from the raw flash slot if the slot holds this
+ * version of it. Frames then come from mapped flash without file system
+ * calls; uncompressed shows are mapped to the LEDs in place.
+ */
+bool openShowSlot() {
+    if (!showSlot.holds(currentShow, sourceFingerprint(currentShow, false))) return false;
+
+    closeShowFile();
+    if (!fseq->open(&showSlot.source())) {
+        Serial.printf("ERR: Flash slot: %s\n", fseq->lastError());
+        closeShowFile();
+        return false;
+    }
+    Serial.printf("Playing %s from the flash slot\n", currentShow.c_str());
+    return true;
+}
 
-    // Virtual Looping: Prevent READ ERROR by wrapping the index within physical file bounds
-    uint32_t safeFrameIdx = frameIdx;
-    if (physicalMaxFrames > 0) {
-        safeFrameIdx = frameIdx % physicalMaxFrames;
+/**
+ * Copies a show from LittleFS into the raw flash slot. Runs from loop()
+ * while idle; the slot stays empty until the copy is complete.
+ */
+bool writeShowSlot(const String& path) {
+    isBusy = true;
+    showStatus("Flashing...");
+    closeShowFile();
+    unsigned long t0 = millis();
+
+    // 1. Only shows the reader can play, and only if they fit
+    bool ok = showSource->open(path) && readFseqHeader();
+    uint32_t length = ok ? showSource->size() : 0;
+    if (ok && fseq->info().compression != FSEQ_COMPRESSION_NONE) {
+        // zlib and .lsq frames must be decoded, only an uncompressed .fseq is read in place
+        Serial.printf("WARN: %s is compressed: the slot plays it through the reader, not zero-copy.\n", path.c_str());
+    }
+    closeShowFile();
+    if (ok && !showSlot.beginWrite(length)) {
+        Serial.printf("ERR: %s (%u KB) does not fit the flash slot (%u KB).\n", path.c_str(), length / 1024,
+                      (showSlot.capacity() - SLOT_HEADER_SIZE) / 1024);
+        ok = false;
     }
 
-    uint32_t targetPos = (uint32_t)fseqDataOffset + (safeFrameIdx * logicalStride);
+    // 2. Copy sector by sector
+    static uint8_t buf[SLOT_SECTOR];
+    File f = ok ? LittleFS.open(path, "r") : File();
+    for (uint32_t pos = 0; ok && pos < length; ) {
+        size_t n = f.read(buf, min((uint32_t)sizeof(buf), length - pos));
+        ok = n > 0 && showSlot.write(pos, buf, n);
+        pos += n;
+        yield();
+    }
+    if (f) f.close();
+
+    // 3. Header last: a slot only counts once the copy is complete
+    if (ok) {
+        ShowSlotHeader header;
+        header.length = length;
+        header.fingerprint = sourceFingerprint(path, false);
+        strncpy(header.name, path.c_str(), SLOT_NAME_LEN - 1);
+        ok = showSlot.commit(header);
+    }
 
-    if (!fseqFile.seek(targetPos)) {
-        Serial.printf("CRITICAL: SEEK ERROR at Frame %u\n", frameIdx);
+    if (ok) {
+        unsigned long ms = max(millis() - t0, 1UL);
+        Serial.printf("Flash slot: %s, %u KB in %lu ms (%.2f MB/s)\n", path.c_str(), length / 1024, ms,
+                      length / 1048.576f / ms);
+    } else {
+        Serial.printf("ERR: Copying %s into the flash slot failed.\n", path.c_str());
+    }
+    uiStateChanged = true;
+    isBusy = false;
+    showStatus("READY");
+    return ok;
+}
+
+/**
+ * Opens the sidecar of 'show' with the current config in 'reader' if it is
+ * still valid: a dense, uncompressed stream with one byte per LED, so each
+ * frame is ~25 bytes instead of a full FSEQ frame.
+ */
+bool openShowSidecar(const String& show, FseqReader& reader, LittleFsSource& source) {
+    String path = sidecarPath(show, currentConfigFile);
+    if (!isIndexed(path)) return false;
+
+    reader.close();
+    bool valid = source.open(path) && reader.open(&source) &&
+                 reader.info().compression == SHOW_CODEC_SIDECAR &&
+                 reader.info().stride == currentConfig.leds.size() &&
+                 reader.info().showFingerprint == sourceFingerprint(show, false) &&
+                 reader.info().configFingerprint == sourceFingerprint(currentConfigFile, true);
+    if (!valid) {
+        Serial.printf("Sidecar %s is stale.\n", path.c_str());
+        reader.close();
+        source.close();
+        LittleFS.remove(path);
+        unindexFile(path);
+        saveFileIndex();
+        compileRequested = true;
         return false;
     }
 
-    // 2. BUFFERING
-    static uint8_t frameData[1024]; 
-    memset(frameData, 0, sizeof(frameData));
-    
-    // Read the logical 512 byte block
-    size_t bytesRead = fseqFile.read(frameData, 512);
+    Serial.printf("Playing sidecar %s (%u bytes/frame)\n", path.c_str(), reader.info().stride);
+    return true;
+}
 
-    // 3. CHANNEL ANALYZER
+/**
+ * Sidecar of the current show in the active reader.
+ */
+bool openShowSidecar() {
+    closeShowFile();
+    return openShowSidecar(currentShow, *fseq, *showSource);
+}
+
+/**
+ * Show compiler: writes the channels the current config references, in LED
+ * order, into a sidecar next to the FSEQ 'show'. Runs from loop() while idle.
+ */
+bool compileShowSidecar(const String& show) {
+    if (!configValid || !LittleFS.exists(show)) return false;
+    if (!show.endsWith(".fseq") && !show.endsWith(".lsq")) return false;
+
+    String path = sidecarPath(show, currentConfigFile);
+    closeShowFile();
+    if (openShowSidecar(show, *fseq, *showSource)) {   // Already compiled and valid
+        closeShowFile();
+        return true;
+    }
+
+    isBusy = true;
+    showStatus("Compiling...");
+    unsigned long t0 = millis();
+
+    closeShowFile();
+    if (!showSource->open(show) || !readFseqHeader()) {
+        Serial.println(F("ERR: Show compiler could not read the FSEQ header."));
+        closeShowFile();
+        isBusy = false;
+        showStatus("READY");
+        return false;
+    }
+
+    uint16_t ledCount = currentConfig.leds.size();
+    uint32_t frames = fseq->info().frameCount;
+    size_t needed = SIDECAR_HEADER_SIZE + (size_t)frames * ledCount;
+    bool ok = LittleFS.totalBytes() - LittleFS.usedBytes() > needed + 204800; // Keep 200 KB reserve
+
+    LittleFsSink out;
+    ok = ok && out.open("/sidecar.tmp");
+    ok = ok && compileSidecar(*fseq, currentConfig.leds, sourceFingerprint(show, false),
+                              sourceFingerprint(currentConfigFile, true), out);
+    out.close();
+    closeShowFile();
+
+    if (ok) {
+        LittleFS.remove(path);
+        ok = LittleFS.rename("/sidecar.tmp", path);
+    } else {
+        LittleFS.remove("/sidecar.tmp");
+    }
+
+    if (ok) {
+        Serial.printf("Show compiled: %s (%u frames x %u bytes) in %lu ms\n",
+                      path.c_str(), frames, ledCount, millis() - t0);
+        indexFile(path);
+        saveFileIndex();
+    } else {
+        Serial.println(F("WARN: Show compile failed (storage full?). Playing the FSEQ directly."));
+    }
+    compileRequested = false; // A stale sidecar found above must not trigger a second pass
+    isBusy = false;
+    showStatus("READY");
+    return ok;
+}
+
+/**
+ * True if the power sidecar at 'path' matches 'expect' (frame count and
+ * both fingerprints).
+ */
+bool powerSidecarValid(const String& path, const PowerHeader& expect) {
+    if (!isIndexed(path)) return false;
+    File f = LittleFS.open(path, "r");
+    uint8_t h[POWER_HEADER_SIZE];
+    PowerHeader header;
+    bool valid = f && f.size() == POWER_HEADER_SIZE + expect.frameCount && f.read(h, sizeof(h)) == sizeof(h) &&
+                 decodePowerHeader(h, header) && header.frameCount == expect.frameCount &&
+                 header.showFingerprint == expect.showFingerprint &&
+                 header.configFingerprint == expect.configFingerprint;
+    if (f) f.close();
+    return valid;
+}
+
+/**
+ * Power limit: precomputes the brightness of every frame of 'show' with the
+ * current config (max_brightness, max_milliamps, mapping and colors) into
+ * a .lsp sidecar. Runs from loop() after the show compiler and reads the
+ * compiled sidecar when there is one.
+ */
+bool compilePowerSidecar(const String& show) {
+    if (!configValid || !LittleFS.exists(show)) return false;
+    if (!show.endsWith(".fseq") && !show.endsWith(".lsq")) return false;
+
+    // 1. Source: the compiled sidecar (LED order) or the show itself
+    closeShowFile();
+    bool ledOrder = openShowSidecar(show, *fseq, *showSource);
+    if (!ledOrder && !(showSource->open(show) && readFseqHeader())) {
+        closeShowFile();
+        return false;
+    }
+    String path = sidecarPath(show, currentConfigFile, ".lsp");
+    PowerHeader header;
+    header.frameCount = fseq->info().frameCount;
+    header.showFingerprint = sourceFingerprint(show, false);
+    header.configFingerprint = sourceFingerprint(currentConfigFile, true);
+    if (powerSidecarValid(path, header)) {
+        closeShowFile();
+        return true;
+    }
+
+    isBusy = true;
+    showStatus("Power plan...");
+    unsigned long t0 = millis();
+
+    // 2. A map of its own: the live one may be in the other order
+    uint16_t n = currentConfig.leds.size();
+    std::vector<uint16_t> src(n);
+    std::vector<uint8_t> color(n);
+    LedMapTable map = { src.data(), color.data(), colorLuts.data(), n };
+    compileLedMap(currentConfig.leds, map, ledOrder, &currentConfig.colors);
+
+    LittleFsSink out;
+    PowerStats stats;
+    bool ok = LittleFS.totalBytes() - LittleFS.usedBytes() > POWER_HEADER_SIZE + header.frameCount + 204800;
+    ok = ok && out.open("/power.tmp");
+    ok = ok && compilePowerScales(*fseq, map, currentConfig.max_brightness,
+                                  (uint32_t)POWER_VOLTS * currentConfig.max_milliamps, header, out, stats);
+    out.close();
+    closeShowFile();
+
+    if (ok) {
+        LittleFS.remove(path);
+        ok = LittleFS.rename("/power.tmp", path);
+    } else {
+        LittleFS.remove("/power.tmp");
+    }
+
+    if (ok) {
+        Serial.printf("Power plan: %s, %u of %u frames limited (lowest brightness %u of %u) in %lu ms\n",
+                      path.c_str(), stats.limitedFrames, header.frameCount, stats.minBrightness,
+                      currentConfig.max_brightness, millis() - t0);
+        indexFile(path);
+        saveFileIndex();
+    } else {
+        Serial.println(F("WARN: Power plan failed. The limit is estimated per frame."));
+    }
+    isBusy = false;
+    showStatus("READY");
+    return ok;
+}
+
+/**
+ * Loads the power scales of 'show' with the current config into 'out'
+ * (frame count from its open reader). Without them frameBrightness() estimates.
+ */
+bool loadPowerScales(const String& show, uint32_t frameCount, std::vector<uint8_t>& out) {
+    out.clear();
+    out.shrink_to_fit();
+
+    String path = sidecarPath(show, currentConfigFile, ".lsp");
+    PowerHeader header;
+    header.frameCount = frameCount;
+    header.showFingerprint = sourceFingerprint(show, false);
+    header.configFingerprint = sourceFingerprint(currentConfigFile, true);
+    if (header.frameCount > POWER_MAX_FRAMES || !powerSidecarValid(path, header)) return false;
+
+    File f = LittleFS.open(path, "r");
+    out.resize(header.frameCount);
+    bool ok = f && f.seek(POWER_HEADER_SIZE) &&
+              f.read(out.data(), header.frameCount) == header.frameCount;
+    if (f) f.close();
+    if (!ok) {
+        out.clear();
+        return false;
+    }
+    Serial.printf("Power limit from %s\n", path.c_str());
+    return true;
+}
+
+/**
+ * Queues an uploaded show for conversion (upload handler). A full queue
+ * leaves the show as an uncompressed .fseq, which still plays.
+ */
+void queueConversion(const String& path) {
+    xSemaphoreTake(conversionMutex, portMAX_DELAY);
+    bool queued = std::find(pendingConversions.begin(), pendingConversions.end(), path) != pendingConversions.end();
+    bool full = !queued && pendingConversions.size() >= CONVERSION_QUEUE;
+    if (!queued && !full) pendingConversions.push_back(path);
+    xSemaphoreGive(conversionMutex);
+    if (full) Serial.printf("WARN: Conversion queue full, %s stays uncompressed.\n", path.c_str());
+}
+
+/**
+ * Takes the oldest queued conversion (loop()). False if none is waiting.
+ */
+bool takeConversion(String& path) {
+    xSemaphoreTake(conversionMutex, portMAX_DELAY);
+    bool any = !pendingConversions.empty();
+    if (any) {
+        path = pendingConversions.front();
+        pendingConversions.erase(pendingConversions.begin());
+    }
+    xSemaphoreGive(conversionMutex);
+    return any;
+}
+
+/**
+ * Delta encoder: converts an uploaded uncompressed FSEQ (V1 or V2, dense or
+ * sparse) into a native .lsq show and removes the original once every frame
+ * has been verified. Only for uploads with "compress" set: the .lsq decodes
+ * every channel, so range reads and slot zero-copy no longer apply. Runs
+ * from loop() while idle and reports the achieved compression ratio plus
+ * the on-device decode time per frame.
+ */
+bool convertShowToDelta(const String& srcPath) {
+    if (!srcPath.endsWith(".fseq") || !LittleFS.exists(srcPath)) return false;
+    String dstPath = srcPath.substring(0, srcPath.length() - 5) + ".lsq";
+
+    isBusy = true;
+    showStatus("Converting...");
+    unsigned long t0 = millis();
+
+    closeShowFile();
+    bool ok = showSource->open(srcPath) && readFseqHeader();
+    if (ok && fseq->info().compression != FSEQ_COMPRESSION_NONE) {
+        Serial.printf("%s is already compressed, kept as is.\n", srcPath.c_str());
+        ok = false;
+    }
+    uint32_t srcSize = ok ? showSource->size() : 0;
+
+    LittleFsSink out;
+    DeltaStats stats;
+    ok = ok && out.open("/convert.tmp");
+    if (ok && !encodeDeltaShow(*fseq, out, stats)) {
+        Serial.printf("ERR: Delta conversion failed at frame %u\n", stats.failedFrame);
+        ok = false;
+    }
+    out.close();
+    closeShowFile();
+
+    if (ok) {
+        LittleFS.remove(dstPath);
+        ok = LittleFS.rename("/convert.tmp", dstPath);
+    } else {
+        LittleFS.remove("/convert.tmp");
+    }
+
+    if (ok) {
+        LittleFS.remove(srcPath);
+        removeSidecarsFor(srcPath);
+        if (currentShow == srcPath) currentShow = dstPath;
+        for (PlaylistEntry& e : playlist) {
+            if (e.show == srcPath) e.show = dstPath;
+        }
+        if (pendingAnalysis == srcPath) pendingAnalysis = dstPath;
+        unindexFile(srcPath);
+        indexFile(dstPath);
+        saveFileIndex();
+        compileRequested = true;
+
+        Serial.printf("Converted %s -> %s in %lu ms\n", srcPath.c_str(), dstPath.c_str(), millis() - t0);
+        Serial.printf("Delta codec: %u -> %u bytes (ratio %.1f:1) | decode avg %.1f us, max %u us per frame\n",
+                      srcSize, stats.bytesOut, srcSize / (float)stats.bytesOut,
+                      stats.frames ? stats.decodeTotalUs / (float)stats.frames : 0.0f, stats.decodeMaxUs);
+    }
+    isBusy = false;
+    showStatus("READY");
+    return ok;
+}
+
+/**
+ * Channel report of a show: "/<showHash>.lsa" (JSON), removed together
+ * with the show's sidecars.
+ */
+String analysisPath(const String& show) {
+    char buf[16];
+    sprintf(buf, "/%08x.lsa", (unsigned)fnv1a(show));
+    return String(buf);
+}
+
+/**
+ * Offline channel analyzer: reads every frame of a show as fast as the
+ * flash delivers and stores the per-channel report for GET /analysis.
+ * Runs from loop() while idle, like the converter.
+ */
+bool analyzeShowFile(const String& path) {
+    if (!LittleFS.exists(path)) return false;
+
+    isBusy = true;
+    showStatus("Analyzing...");
+    closeShowFile();
+
+    ChannelAnalysis analysis;
+    bool ok = showSource->open(path) && readFseqHeader();
+    if (ok && !analyzeChannels(*fseq, analysis)) {
+        Serial.printf("CRITICAL: %s at Frame %u\n", fseq->lastError(), analysis.failedFrame);
+        ok = false;
+    }
+    closeShowFile();
+
+    LittleFsSink out;
+    ok = ok && out.open("/analysis.tmp") && writeChannelReport(analysis, path.c_str() + 1, out);
+    out.close();
+    String report = analysisPath(path);
+    if (ok) {
+        ok = LittleFS.rename("/analysis.tmp", report);
+    } else if (LittleFS.exists("/analysis.tmp")) {
+        LittleFS.remove("/analysis.tmp");
+    }
+
+    if (ok) {
+        Serial.printf("Analyzed %s: %u frames in %u ms (%.0fx show speed) -> %s\n", path.c_str(), analysis.frames,
+                      analysis.scanUs / 1000, analysis.frames * analysis.stepTimeMs * 1000.0f / max(analysis.scanUs, 1u),
+                      report.c_str());
+        indexFile(report);
+        saveFileIndex();
+    } else {
+        Serial.printf("ERR: Channel analysis of %s failed.\n", path.c_str());
+    }
+    isBusy = false;
+    showStatus("READY");
+    return ok;
+}
+
+/**
+ * Prints the frame release lateness histogram (release time - deadline).
+ */
+void logFrameLateness(const char* prefix) {
+    const uint32_t* hist = frameClock.lateness();
+    String line = prefix;
+    line += "LATENESS:";
+    for (uint8_t i = 0; i < FRAME_CLOCK_BUCKETS; i++) {
+        uint32_t limit = FrameClock::bucketLimitUs(i);
+        char buf[24];
+        if (limit) sprintf(buf, " <%uus %u |", (unsigned)limit, (unsigned)hist[i]);
+        else sprintf(buf, " more %u |", (unsigned)hist[i]);
+        line += buf;
+    }
+    Serial.printf("%s avg %u us, max %u us, skipped %u\n", line.c_str(),
+                  frameClock.avgLateUs(), frameClock.maxLateUs(), frameClock.skipped());
+}
+
+/**
+ * Show identity shared by all cars: file name without folder and extension
+ * (a converted .lsq keeps its .fseq name), frame count and step time.
+ * Modification times differ between cars, so the file fingerprint is not used.
+ */
+uint32_t showIdFor(const String& path, const FseqInfo& info) {
+    String base = path.substring(path.lastIndexOf('/') + 1);
+    int dot = base.lastIndexOf('.');
+    if (dot > 0) base = base.substring(0, dot);
+    uint32_t meta[2] = { info.frameCount, info.stepTimeMs };
+    return fnv1a((const uint8_t*)meta, sizeof(meta), fnv1a(base));
+}
+
+/**
+ * Leader: broadcasts the show position every BEACON_INTERVAL_MS.
+ * Runs in loop(); the timestamp is taken right before the send, so loop()
+ * latency does not end up in the beacon.
+ */
+void sendSyncBeacon() {
+    static uint32_t lastBeacon = 0;
+    static uint16_t sequence = 0;
+    if (syncRole != SYNC_LEADER || !showRunning) return;
+    if (millis() - lastBeacon < BEACON_INTERVAL_MS) return;
+    lastBeacon = millis();
+
+    ClockBeacon beacon;
+    beacon.showId = showId;
+    beacon.frame = frameClock.current();
+    beacon.stepTimeMs = frameClock.stepTimeMs();
+    beacon.sequence = sequence++;
+    beacon.showTimeUs = frameClock.elapsedUs(engineMicros64());
+
+    uint8_t packet[BEACON_SIZE];
+    encodeBeacon(beacon, packet);
+    beaconUdp.broadcastTo(packet, sizeof(packet), BEACON_PORT);
+}
+
+/**
+ * Power limit estimated from the pixels (shows without a power sidecar, analyzer).
+ */
+uint8_t estimateBrightness() {
+    return limitBrightness(unscaledPowerMw(leds, ledCount), currentConfig.max_brightness,
+                           (uint32_t)POWER_VOLTS * currentConfig.max_milliamps);
+}
+
+/**
+ * Brightness for a frame: the precomputed power scale, or the estimate.
+ */
+uint8_t frameBrightness(uint32_t frameIdx) {
+    return frameIdx < powerScales.size() ? powerScales[frameIdx] : estimateBrightness();
+}
+
+/**
+ * FINAL RELEASE VERSION 1.0.0
+ * Features: Prefetched Frames, Sparse Channel Remapping, Channel Analyzer.
+ * Takes the pre-read frame from the ring; the file is never touched here.
+ */
+bool playFrame(uint32_t frameIdx) {
+    if (!fseq->isOpen() || frameIdx >= fseq->info().frameCount) return false;
+    uint32_t frameStart = micros();
+
+    // 1. DEQUEUE the requested frame, dropping stale ones (zero-copy: in place from mapped flash)
+    const uint8_t* frameData;
+    if (zeroCopy) {
+        frameData = fseq->directFrame(frameIdx);
+    } else {
+        // The previous frame was only kept as blend source
+        if (heldFrame) {
+            ringTail.store(ringTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            heldFrame = false;
+            xTaskNotifyGive(readerTaskHandle);
+        }
+        ringWanted.store(frameIdx, std::memory_order_relaxed);
+        const FrameSlot* slot = nullptr;
+        bool underrun = false;
+        unsigned long waitStart = millis();
+
+        while (!slot) {
+            uint32_t tail = ringTail.load(std::memory_order_relaxed);
+            uint32_t head = ringHead.load(std::memory_order_acquire);
+
+            if (head == tail) {
+                if (readerFailed) return false;
+                if (!underrun) { ringUnderruns++; ringUnderrunsTotal++; underrun = true; }
+                if (millis() - waitStart > 1000) {
+                    Serial.printf("CRITICAL: READER STALL at Frame %u\n", frameIdx);
+                    return false;
+                }
+                xTaskNotifyGive(readerTaskHandle);
+                vTaskDelay(1);
+                continue;
+            }
+
+            ringMinFill = min(ringMinFill, head - tail);
+            const FrameSlot& candidate = frameRing[tail % FRAME_RING_DEPTH];
+            SlotAction action = judgeSlot(candidate, renderSegment.load(std::memory_order_relaxed), frameIdx);
+            if (action == SLOT_MISSING) {
+                Serial.printf("CRITICAL: Frame %u missing before the next show\n", frameIdx);
+                return false;
+            }
+            if (action == SLOT_DROP) {
+                ringTail.store(tail + 1, std::memory_order_release);
+                ringDropped++;
+                ringDroppedTotal++;
+                continue;
+            }
+            slot = &candidate;
+        }
+        frameData = slot->data;
+    }
+    uint32_t mapStart = micros();
+    pipelineMetrics.add(STAGE_WAIT, mapStart - frameStart);
+
+    // 2. CHANNEL ANALYZER
     if (scanActive) {
         // Find peaks across all 512 logical channels
         for (int i = 0; i < 512; i++) {
             if (frameData[i] > globalMax[i]) globalMax[i] = frameData[i];
         }
         // Visual feedback on the first 32 LEDs
-        for (int i = 0; i < 32; i++) {
+        for (int i = 0; i < min(32, (int)ledCount); i++) {
             leds[i] = CRGB(frameData[i], frameData[i], frameData[i]);
         }
-    } 
-    else {
-        // 4. NORMAL MAPPING (THE SIMON-SYNC)
-        size_t totalLeds = currentConfig.leds.size();
-        for (size_t i = 0; i < totalLeds; i++) {
-            uint16_t rawCh = currentConfig.leds[i].channel;
-            if (rawCh == 9999) { leds[i] = CRGB::Black; continue; }
-            
-            // Absolute Addressing: Triple LEDs now work in perfect sync!
-            uint8_t val = (rawCh < 1024) ? frameData[rawCh] : 0;
-
-            // --- PRECISION COLOR LOGIC (V1.0.0) ---
-            if (rawCh == 139 || rawCh == 142 || rawCh == 339 || rawCh == 342) {
-                leds[i] = CRGB(val, (val * 160) >> 8, 0); // Amber Indicators
-            } 
-            else if ((rawCh >= 364 && rawCh <= 371) || rawCh == 392) {
-                leds[i] = CRGB(val, 0, 0); // Red Brake/Rear
-            }
-            else if (rawCh >= 151 && rawCh <= 160) {
-                leds[i] = CRGB((val * 100) >> 8, (val * 100) >> 8, val); // Blue Matrix
-            }
-            else {
-                leds[i] = CRGB(val, val, val); // White Main Beams/Reverse
-            }
+    } 
+    else {
+        // 3. NORMAL MAPPING (THE SIMON-SYNC) via the compiled LED map
+        mapFrameToLeds(frameData, ledMap, leds);
+    }
+
+    // 4. RELEASE the slot so the reader refills it while the LEDs latch (interpolation: keep it until the next frame)
+    if (blendSubs > 1 && !zeroCopy) {
+        heldFrame = true;
+    } else if (!zeroCopy) {
+        ringTail.store(ringTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        xTaskNotifyGive(readerTaskHandle);
+    }
+
+    uint32_t showStart = micros();
+    ledOutput.show(frameBrightness(frameIdx));
+    uint32_t frameEnd = micros();
+    pipelineMetrics.add(STAGE_MAP, showStart - mapStart);
+    pipelineMetrics.add(STAGE_SHOW, frameEnd - showStart);
+    pipelineMetrics.add(STAGE_FRAME, frameEnd - frameStart);
+    return (frameIdx + 1) < fseq->info().frameCount;
+}
+
+/**
+ * Interpolation tick: shows frame 'frameIdx' blended toward the next one by
+ * weight/256. Both frames are already in memory (held slot and the one after
+ * it, or mapped flash); false if the next one is not read yet, the LEDs then
+ * keep the last frame.
+ */
+bool renderBlend(uint32_t frameIdx, uint16_t weight) {
+    const uint8_t* from;
+    const uint8_t* to;
+    if (zeroCopy) {
+        from = fseq->directFrame(frameIdx);
+        to = fseq->directFrame(frameIdx + 1);
+    } else {
+        uint32_t tail = ringTail.load(std::memory_order_relaxed);
+        uint32_t head = ringHead.load(std::memory_order_acquire);
+        if (!heldFrame || head - tail < 2) return false;
+        const FrameSlot& current = frameRing[tail % FRAME_RING_DEPTH];
+        const FrameSlot& next = frameRing[(tail + 1) % FRAME_RING_DEPTH];
+        if (current.frameIdx != frameIdx || next.frameIdx != frameIdx + 1 || next.segment != current.segment) return false;
+        from = current.data;
+        to = next.data;
+    }
+    if (!from || !to) return false;
+
+    blendFrameToLeds(from, to, weight, ledMap, leds);
+
+    // A blend draws no more than the brighter of its frames: the lower limit holds
+    if (frameIdx + 1 < powerScales.size()) ledOutput.show(min(powerScales[frameIdx], powerScales[frameIdx + 1]));
+    else ledOutput.show(estimateBrightness());
+    return true;
+}
+
+/**
+ * Playlist: the prepared next show takes over on the deadline after the last
+ * frame, on the same clock, so its frame 0 follows with no gap. Only
+ * pointers and buffers prepared by loop() change hands (no file access, no
+ * allocation); loop() closes the finished show afterwards.
+ */
+void switchToNextShow() {
+    uint64_t boundaryUs = frameClock.deadline(fseq->info().frameCount);
+    logFrameLateness("Show ");
+
+    std::swap(fseq, nextFseq);
+    std::swap(showSource, nextSource);
+    powerScales.swap(nextPowerScales);
+    ledSrc.swap(nextLedSrc);
+    ledColor.swap(nextLedColor);
+    ledMap.src = ledSrc.data();
+    ledMap.color = ledColor.data();
+    blendSubs = nextBlendSubs;
+    playingSidecar = nextSidecar;
+    playingSlot = false;
+    showId = nextShowId;
+
+    // The reader already stores the new show's frames behind the last one
+    ringWanted.store(0, std::memory_order_relaxed);
+    renderSegment.fetch_add(1, std::memory_order_release);
+    frameClock.start(boundaryUs, fseq->info().stepTimeMs, 0);
+    transitionUs = boundaryUs;
+    nextReady = false;
+    showSwitched = true;
+}
+
+/**
+ * esp_timer callback (timer task): the render task's deadline is close.
+ */
+void wakeRenderTask(void* arg) {
+    xTaskNotifyGive(renderTaskHandle);
+}
+
+/**
+ * Render task: owns the frame deadlines while a show runs. It sleeps on the
+ * renderWake one-shot until the next deadline (frame or interpolation tick)
+ * is less than FRAME_SPIN_US away, spins for the rest and plays the frame.
+ * Running above AsyncTCP, neither web traffic nor OLED, OTA or countdown
+ * work in loop() can delay a frame; the short spin keeps it from starving
+ * them in turn.
+ */
+void renderTask(void* param) {
+    uint32_t totalProcessTime = 0;
+    uint32_t spinUs = 0;            // Spent spinning since the last performance report
+    uint16_t sampleCounter = 0;
+    uint32_t blendFrame = 0;        // Last played frame, source of the interpolation ticks
+    uint8_t blendSub = BLEND_MAX_SUBS;
+    uint32_t blendUs = 0, blendCount = 0;
+
+    for (;;) {
+        // Announce the frame before checking the flag (see stopPlayback)
+        renderBusy = true;
+        if (!showRunning) {
+            renderBusy = false;
+            totalProcessTime = 0;
+            spinUs = 0;
+            sampleCounter = 0;
+            blendSub = BLEND_MAX_SUBS;
+            blendUs = blendCount = 0;
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        // 1. Follower: slew toward the leader (beacons are timestamped on arrival)
+        BeaconRx rx;
+        while (xQueueReceive(beaconQueue, &rx, 0) == pdTRUE) {
+            frameClock.shift(clockFollower.onBeacon(rx.beacon, frameClock.elapsedUs(rx.rxUs)));
+        }
+
+        // 2. Drift-free timing: the next interpolation tick while one is left before the frame, else the frame
+        bool blend = blendSub < blendSubs && blendFrame + 1 == frameClock.current();
+        uint64_t dueUs = blend ? frameClock.tickDeadline(blendFrame, blendSub, blendSubs)
+                               : frameClock.deadline(frameClock.current());
+        int64_t wait = (int64_t)(dueUs - engineMicros64());
+        if (wait > FRAME_SPIN_US) {
+            renderBusy = false;
+            esp_timer_stop(renderWake);   // Re-armed for this deadline (a notification may have come first)
+            esp_timer_start_once(renderWake, wait - FRAME_SPIN_US);
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait / 1000) + 2);   // Timeout: fallback only
+            continue;
+        }
+        uint64_t spinStart = engineMicros64();
+        while ((int64_t)(dueUs - engineMicros64()) > 0) { }
+        uint32_t spun = engineMicros64() - spinStart;
+        spinUs += spun;
+        renderSpinUsTotal += spun;
+
+        if (blend) {
+            // Late enough that the frame itself is due: skip the remaining ticks
+            if (frameClock.untilDue(engineMicros64()) <= 0) {
+                blendSub = blendSubs;
+                continue;
+            }
+            uint32_t blendStart = micros();
+            if (renderBlend(blendFrame, blendSub * 256 / blendSubs)) {
+                uint32_t tickUs = micros() - blendStart;
+                pipelineMetrics.add(STAGE_BLEND, tickUs);
+                blendUs += tickUs;
+                blendCount++;
+            } else {
+                blendSkipped++;
+            }
+            blendSub++;
+            continue;
+        }
+
+        // 3. Playback logic (jumps ahead when more than 2 frames behind)
+        uint64_t releaseUs = engineMicros64();
+        uint32_t skippedBefore = frameClock.skipped();
+        if (!frameClock.poll(releaseUs)) continue;
+        framesSkipped += frameClock.skipped() - skippedBefore;
+        unsigned long startMicros = micros();
+
+        if (!playFrame(frameClock.current())) {
+            // Playlist: the next show goes on where this one ends
+            if (nextReady && !readerFailed && frameClock.current() + 1 >= fseq->info().frameCount) {
+                switchToNextShow();
+                blendSub = BLEND_MAX_SUBS;
+                continue;
+            }
+            showRunning = false;
+            showEnded = true; // loop() stops the reader and closes the file
+            continue;
+        }
+        if (joinRequestUs) {
+            uint64_t nowUs = engineMicros64();
+            lastJoinFrame = frameClock.current();
+            lastJoinTtffUs = nowUs - joinRequestUs;
+            joinRequestUs = 0;
+            Serial.printf(">>> LATE JOIN: Frame %u | First frame after %u ms | %lld us after its deadline\n",
+                          lastJoinFrame, lastJoinTtffUs / 1000,
+                          (long long)(nowUs - frameClock.deadline(lastJoinFrame)));
+        }
+        if (transitionUs) {
+            lastGapUs = releaseUs - transitionUs;
+            maxGapUs = max(maxGapUs, lastGapUs);
+            playlistSwitches++;
+            transitionUs = 0;
+            Serial.printf(">>> PLAYLIST: Next show on frame %u, %u us after the last one ended\n",
+                          frameClock.current(), lastGapUs);
+        }
+        uint32_t lateUs = releaseUs - frameClock.deadline(frameClock.current());
+        frameLateness.add(lateUs);
+        framesLate += lateUs > METRICS_LATE_US;
+        framesPlayed++;
+        blendFrame = frameClock.current();
+        blendSub = 1;
+        frameClock.advance();
+
+        // 4. Calculate and monitor performance (per-stage histograms: GET /metrics)
+        uint32_t duration = micros() - startMicros;
+        totalProcessTime += duration;
+        sampleCounter++;
+
+        if (sampleCounter >= 100) {
+            uint32_t avg = totalProcessTime / 100;
+            Serial.printf(">>> PERFORMANCE: Avg Frame Time %u us | Target: %u ms\n", avg, frameClock.stepTimeMs());
+            if (fseq->info().compression == FSEQ_COMPRESSION_ZLIB) {
+                Serial.printf(">>> INFLATE: Last frame %u us\n", fseq->inflateMicros());
+            }
+            Serial.printf(">>> RING: Depth %d | Min Fill %u | Underruns %u | Dropped %u\n",
+                          FRAME_RING_DEPTH, ringMinFill, ringUnderruns, ringDropped);
+            ringMinFill = FRAME_RING_DEPTH;
+            logFrameLateness(">>> ");
+            Serial.printf(">>> SPIN: Avg %u us per frame (%u.%u%% CPU)\n", spinUs / 100,
+                          spinUs / frameClock.stepTimeMs() / 1000, spinUs / frameClock.stepTimeMs() / 100 % 10);
+            spinUs = 0;
+            if (blendSubs > 1) {
+                Serial.printf(">>> BLEND: %u outputs per frame | Avg tick %u us | Skipped %u\n", blendSubs,
+                              blendCount ? blendUs / blendCount : 0, blendSkipped);
+                blendUs = blendCount = 0;
+            }
+            if (syncRole == SYNC_FOLLOWER) {
+                Serial.printf(">>> SYNC: Phase %lld us | Beacons %u | Jumps %u\n", (long long)clockFollower.phaseErrorUs(),
+                              clockFollower.beacons(), clockFollower.jumps());
+            }
+            if (avg >= frameClock.stepTimeMs() * 1000UL) {
+                Serial.println("!!! WARNING: Storage or CPU too slow!");
+            }
+            totalProcessTime = 0;
+            sampleCounter = 0;
+        }
+    }
+}
+
+/**
+ * Stops playback: waits until the render task has left playFrame() and the
+ * reader has left the show file. Safe to call from loop() and web handlers.
+ */
+void stopPlayback() {
+    showRunning = false;
+    xTaskNotifyGive(renderTaskHandle);
+    while (renderBusy) vTaskDelay(1);
+    stopFramePrefetch();
+}
+
+/**
+ * Stops the current show, clears all LEDs, and closes open file handles.
+ * Resets playback variables for a clean system state.
+ */
+void stopShowAndCleanup() {
+    isBusy = true; 
+
+    // 1. Stop the render task and the reader before touching LEDs or the file
+    stopPlayback();
+    
+    // 2. Turn off LEDs (immediate feedback)
+    FastLED.clear(true);
+    ledOutput.show(0);
+
+    // 3. Close file (both tasks have left it)
+    closeShowFile();
+    closeNextShow();
+    if (showSwitched) followPlaylistSwitch();
+    nextFailed = false;
+    transitionUs = 0;
+    playingSlot = false;
+    zeroCopy = false;
+    powerScales.clear();
+    powerScales.shrink_to_fit();
+
+    if (frameClock.current() > 0) logFrameLateness("Show ");
+    showStartEpoch = 0;
+    frameClock.reset();
+    isBusy = false;
+    scanActive = false; // Reset scan mode after show ends
+
+    showStatus("READY");
+    Serial.println(F("Clean exit."));
+}
+
+/**
+ * Deletes a specific file from LittleFS storage.
+ * Redirects the user back to the main dashboard after completion.
+ */
+void handleDelete(AsyncWebServerRequest *request) {
+    if (showRunning || isBusy) {
+        request->send(403, "text/plain", "Cannot delete files while show is active!");
+        return;
+    }
+
+    if (request->hasParam("file")) {
+        String filename = request->getParam("file")->value();
+        if (!filename.startsWith("/")) filename = "/" + filename;
+        if (filename == UI_ASSET) {
+            request->send(403, "text/plain", "The Web UI asset cannot be deleted.");
+            return;
+        }
+        
+        if (LittleFS.exists(filename)) {
+            LittleFS.remove(filename);
+            uint8_t kind = fileKindOf(filename.c_str());
+            if (kind == FILE_KIND_SHOW || kind == FILE_KIND_CONFIG) removeSidecarsFor(filename);
+            unindexFile(filename);
+            saveFileIndex();
+            Serial.printf("Deleted and index updated: %s\n", filename.c_str());
+        }
+    }
+    // Redirect back to main page immediately
+    request->redirect("/");
+}
+
+/**
+ * Queues the offline channel analyzer for a show (POST /analyze, show=name).
+ * The report appears at /analysis?show=name once loop() has run the job.
+ */
+void handleAnalyze(AsyncWebServerRequest *request) {
+    if (!request->hasParam("show", true)) {
+        request->send(400, "text/plain", "Error: Missing show parameter");
+        return;
+    }
+    String show = request->getParam("show", true)->value();
+    if (!show.startsWith("/")) show = "/" + show;
+    if (!(show.endsWith(".fseq") || show.endsWith(".lsq")) || !LittleFS.exists(show)) {
+        request->send(404, "text/plain", "Show not found");
+        return;
+    }
+    if (showRunning) {
+        request->send(409, "text/plain", "Show in progress.");
+        return;
+    }
+    pendingAnalysis = show;
+    request->send(202, "application/json", "{\"queued\":true}");
+}
+
+/**
+ * Queues a copy of a show into the raw flash slot (POST /slot, show=name).
+ */
+void handleSlot(AsyncWebServerRequest *request) {
+    if (!showSlot.available()) {
+        request->send(404, "text/plain", "No flash slot partition (see partitions_showslot.csv)");
+        return;
+    }
+    if (!request->hasParam("show", true)) {
+        request->send(400, "text/plain", "Error: Missing show parameter");
+        return;
+    }
+    String show = request->getParam("show", true)->value();
+    if (!show.startsWith("/")) show = "/" + show;
+    if (!(show.endsWith(".fseq") || show.endsWith(".lsq")) || !LittleFS.exists(show)) {
+        request->send(404, "text/plain", "Show not found");
+        return;
+    }
+    if (showRunning) {
+        request->send(409, "text/plain", "Show in progress.");
+        return;
+    }
+    pendingSlotWrite = show;
+    request->send(202, "application/json", "{\"queued\":true}");
+}
+
+/**
+ * Sets the playlist (POST /playlist, items = one "show" or "show|config" per
+ * line; the config defaults to the selected one, empty clears the list). The
+ * first entry becomes the selected show.
+ */
+void handlePlaylist(AsyncWebServerRequest *request) {
+    if (showRunning || isBusy) {
+        request->send(409, "text/plain", "Show in progress.");
+        return;
+    }
+    String items = request->hasParam("items", true) ? request->getParam("items", true)->value() : "";
+    std::vector<PlaylistEntry> list;
+    int pos = 0;
+    while (pos < (int)items.length()) {
+        int end = items.indexOf('\n', pos);
+        if (end < 0) end = items.length();
+        String line = items.substring(pos, end);
+        pos = end + 1;
+        line.trim();
+        if (line.isEmpty()) continue;
+
+        PlaylistEntry e;
+        int bar = line.indexOf('|');
+        e.show = bar < 0 ? line : line.substring(0, bar);
+        e.config = bar < 0 ? currentConfigFile : line.substring(bar + 1);
+        e.show.trim();
+        e.config.trim();
+        if (!e.show.startsWith("/")) e.show = "/" + e.show;
+        if (!e.config.startsWith("/")) e.config = "/" + e.config;
+        if (!LittleFS.exists(e.show) || !LittleFS.exists(e.config)) {
+            request->send(404, "text/plain", "Not found: " + line);
+            return;
+        }
+        if (list.size() >= PLAYLIST_MAX) {
+            request->send(400, "text/plain", "Error: At most " + String(PLAYLIST_MAX) + " entries");
+            return;
         }
+        list.push_back(e);
     }
 
-    FastLED.show();
-    return (frameIdx + 1) < frameCount;
+    playlist = list;
+    playlistPos = 0;
+    lastGapUs = maxGapUs = 0;
+    playlistSwitches = 0;
+    if (!playlist.empty()) selectPlaylistEntry(0);
+    compileRequested = true;   // Sidecars for every entry on the selected config
+    uiStateChanged = true;
+    Serial.printf("Playlist: %u entries\n", (unsigned)playlist.size());
+    request->send(200, "application/json", "{\"entries\":" + String(playlist.size()) + "}");
 }
 
 /**
- * Stops the current show, clears all LEDs, and closes open file handles.
- * Resets playback variables for a clean system state.
+ * Serves a stored channel report (GET /analysis?show=name).
  */
-void stopShowAndCleanup() {
-    isBusy = true; 
-    showRunning = false;
-    
-    // 1. Turn off LEDs first (immediate feedback)
-    FastLED.clear(true);
-    FastLED.show();
-    
-    // 2. Small pause to let the CPU settle
-    delay(200);
-    yield();
-
-    // 3. Close file carefully
-    if (fseqFile) {
-        fseqFile.close();
-        // The most important line for ESP32-C3 stability:
-        fseqFile = File(); 
+void handleAnalysis(AsyncWebServerRequest *request) {
+    String show = request->hasParam("show") ? request->getParam("show")->value() : "";
+    if (!show.startsWith("/")) show = "/" + show;
+    String report = analysisPath(show);
+    if (!LittleFS.exists(report)) {
+        request->send(404, "application/json", "{\"error\":\"Not analyzed yet\"}");
+        return;
     }
+    request->send(LittleFS, report, "application/json");
+}
 
-    showStartEpoch = 0;
-    currentFrame = 0;
-    isBusy = false;
-    scanActive = false; // Reset scan mode after show ends
+/**
+ * Upload feedback page with Tesla-style status colors.
+ */
+void sendUploadResult(AsyncWebServerRequest *request, bool isValid, const String& message) {
+    String statusColor = isValid ? "#4CAF50" : "#f44336";
+    String html = "<html><head><meta name='viewport' content='width=device-width, initial-scale=1'></head>";
+    html += "<body style='font-family:Arial;text-align:center;background:#121212;color:white;padding:20px;'>";
+    html += "<div style='background:#1e1e1e;padding:30px;border-radius:12px;border-top:5px solid " + statusColor + ";display:inline-block;width:90%;max-width:400px;'>";
+    html += "<h2>" + message + "</h2>";
+    html += "<p style='color:#888;'>File: " + lastUploadedFilename + "</p>";
+    html += "<br><a href='/' style='display:block;background:#cc0000;color:white;padding:15px;text-decoration:none;border-radius:6px;font-weight:bold;'>[ Back to Dashboard ]</a>";
+    html += "</div></body></html>";
+    request->send(isValid ? 200 : 400, "text/html", html);
+}
 
-    showStatus("READY");
-    Serial.println(F("Clean exit."));
+/**
+ * Drops the upload: temp file and buffer are discarded, the error page goes
+ * out at once (the connection closes after it, no further data is written)
+ * and the next upload may start.
+ */
+void rejectUpload(AsyncWebServerRequest *request, const String& message) {
+    if (request->_tempFile) request->_tempFile.close();
+    if (LittleFS.exists(UPLOAD_TMP)) LittleFS.remove(UPLOAD_TMP);
+    free(upload.buf);
+    upload.buf = nullptr;
+    upload.owner = nullptr;
+    upload.rejected = request;
+    Serial.printf("ERR: Upload rejected: %s (%s)\n", lastUploadedFilename.c_str(), message.c_str());
+    sendUploadResult(request, false, message);
 }
 
 /**
- * Deletes a specific file from LittleFS storage.
- * Redirects the user back to the main dashboard after completion.
+ * Writes the coalesced block; false if the file system is full.
  */
-void handleDelete(AsyncWebServerRequest *request) {
-    if (showRunning || isBusy) {
-        request->send(403, "text/plain", "Cannot delete files while show is active!");
-        return;
+bool flushUploadBlock(AsyncWebServerRequest *request) {
+    bool ok = request->_tempFile.write(upload.buf, upload.fill) == upload.fill;
+    upload.fill = 0;
+    return ok;
+}
+
+/**
+ * Chunked upload: incoming TCP chunks are collected into UPLOAD_BLOCK writes
+ * to a temp file. Shows are rejected as soon as their header is in, before
+ * anything reaches the flash.
+ */
+void handleUploadChunk(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final) {
+    // 1. New upload: sanitize filename and set up the job. Another request's
+    //    job keeps its buffer and temp file (answered 409 in handleUploadDone)
+    if (!index) {
+        bool ownerActive = upload.owner && upload.owner != request && millis() - upload.lastChunkMs < UPLOAD_IDLE_MS;
+        if (ownerActive) {
+            Serial.printf("WARN: Upload of %s refused, another upload is in progress\n", filename.c_str());
+            return;
+        }
+        lastUploadedFilename = filename.startsWith("/") ? filename.substring(1) : filename;
+        free(upload.buf);
+        upload = UploadJob();
+        upload.owner = request;
+        upload.startMs = millis();
+        upload.isShow = lastUploadedFilename.endsWith(".fseq") || lastUploadedFilename.endsWith(".lsq");
+        Serial.printf("Uploading: %s\n", lastUploadedFilename.c_str());
+
+        if (showRunning && ("/" + lastUploadedFilename) == currentShow) {
+            rejectUpload(request, "Cannot replace the show that is playing.");
+            return;
+        }
+        if (request->contentLength() > LittleFS.totalBytes() - LittleFS.usedBytes()) {
+            rejectUpload(request, "Not enough storage for this file.");
+            return;
+        }
+        upload.buf = (uint8_t*)malloc(UPLOAD_BLOCK);
+        if (LittleFS.exists(UPLOAD_TMP)) LittleFS.remove(UPLOAD_TMP);
+        request->_tempFile = LittleFS.open(UPLOAD_TMP, "w");
+        if (!upload.buf || !request->_tempFile) {
+            rejectUpload(request, "Cannot start the upload (heap or storage).");
+            return;
+        }
+    }
+    if (upload.owner != request || upload.rejected == request || !upload.buf) return;
+    upload.lastChunkMs = millis();
+
+    // 2. Coalesce into block-sized writes
+    while (len) {
+        size_t n = min(len, (size_t)UPLOAD_BLOCK - upload.fill);
+        memcpy(upload.buf + upload.fill, data, n);
+        upload.fill += n;
+        upload.total += n;
+        data += n;
+        len -= n;
+
+        // Early show validation: the first block is still in RAM here
+        if (upload.isShow && !upload.headerChecked && upload.total >= 32) {
+            upload.headerChecked = true;
+            const char* error = checkShowHeader(upload.buf, upload.fill);
+            if (error) { rejectUpload(request, error); return; }
+        }
+        if (upload.fill == UPLOAD_BLOCK && !flushUploadBlock(request)) {
+            rejectUpload(request, "Write failed, storage full?");
+            return;
+        }
     }
+    yield(); // Give ESP32-C3 time for background tasks (WiFi/WDT)
 
-    if (request->hasParam("file")) {
-        String filename = request->getParam("file")->value();
-        if (!filename.startsWith("/")) filename = "/" + filename;
-        
-        if (LittleFS.exists(filename)) {
-            LittleFS.remove(filename);
-            // --- CACHE ERNEUERN ---
-            refreshFileCache(); 
-            Serial.printf("Deleted and Cache refreshed: %s\n", filename.c_str());
+    if (!final) return;
+
+    // 3. Complete: flush the tail and check what could not be checked earlier
+    if (upload.isShow && !upload.headerChecked) {
+        const char* error = checkShowHeader(upload.buf, upload.fill);
+        if (error) { rejectUpload(request, error); return; }
+    }
+    if (upload.fill && !flushUploadBlock(request)) {
+        rejectUpload(request, "Write failed, storage full?");
+        return;
+    }
+    request->_tempFile.close();
+    free(upload.buf);
+    upload.buf = nullptr;
+
+    // Validation: Check if the uploaded JSON is syntactically correct
+    if (lastUploadedFilename.endsWith(".json")) {
+        File file = LittleFS.open(UPLOAD_TMP, "r");
+        JsonDocument doc;
+        DeserializationError error = deserializeJson(doc, file);
+        file.close();
+        if (error) {
+            rejectUpload(request, "JSON ERROR: " + String(error.c_str()));
+            return;
         }
     }
-    // Redirect back to main page immediately
-    request->redirect("/");
+
+    // 4. Atomic replace: readers see either the old or the complete new file
+    String path = "/" + lastUploadedFilename;
+    if (!LittleFS.rename(UPLOAD_TMP, path)) {
+        rejectUpload(request, "Could not store the file.");
+        return;
+    }
+    uint32_t ms = max((uint32_t)1, (uint32_t)(millis() - upload.startMs));
+    Serial.printf("Upload: %u bytes in %u ms (%.2f MB/s)\n", (unsigned)upload.total, (unsigned)ms,
+                  upload.total / 1048.576 / ms);
+
+    // Replaced sources (.fseq, .lsq, configs) invalidate their compiled sidecars
+    uint8_t kind = fileKindOf(path.c_str());
+    if (kind == FILE_KIND_SHOW || kind == FILE_KIND_CONFIG) {
+        removeSidecarsFor(path);
+        compileRequested = true;
+    }
+    // Uncompressed shows are re-encoded into the native delta format on request only:
+    // an .lsq is smaller but loses range reads and zero-copy from the flash slot
+    bool compress = request->hasParam("compress", true) || request->hasParam("compress");
+    if (path.endsWith(".fseq") && compress) queueConversion(path);
+    if (path == UI_ASSET) refreshUiEtag();
+    indexFile(path);
+    saveFileIndex();
+    Serial.println(F("Upload complete & index updated."));
 }
 
 /**
- * Main Web Interface Handler for the S3XY Lightshow Controller.
- * Manages HTTP GET for UI rendering and HTTP POST for show configuration.
- * Features: Automatic Hardware Discovery, UTC Synchronization, and Live Status Updates.
+ * Final upload response (after the last chunk). Rejected uploads have
+ * already been answered by the chunk handler.
  */
-void handleTeslaApp(AsyncWebServerRequest *request) {
-    // --- 1. SAFETY & PERFORMANCE HEADERS ---
-    if (showRunning) {
-        request->send(200, "text/plain", "Show in progress. Check OLED.");
+void handleUploadDone(AsyncWebServerRequest *request) {
+    if (upload.rejected == request) {
+        upload.rejected = nullptr;
+        return;
+    }
+    if (upload.owner != request) {
+        request->send(409, "text/plain", "Another upload is in progress.");
         return;
     }
+    upload.owner = nullptr;
+    sendUploadResult(request, true, "Upload successful!");
+}
 
-    // --- 2. POST DATA PROCESSING ---
+/**
+ * Main Web Interface Handler for the S3XY Lightshow Controller.
+ * Manages HTTP GET for the static UI asset and HTTP POST for show configuration.
+ * The page itself renders from /api/state (see web/index.html).
+ */
+void handleTeslaApp(AsyncWebServerRequest *request) {
+    // --- 1. POST DATA PROCESSING ---
     if (request->method() == HTTP_POST) {
+        // Selections are locked while the show plays or the reader still holds the file
+        if (showRunning || prefetchActive || readerBusy) {
+            request->send(409, "text/plain", "Show in progress.");
+            return;
+        }
+
+
         // If a Show was just started, stop POST 
         if (isBusy) { request->redirect("/"); return; }
 
@@ -532,6 +2186,7 @@ void handleTeslaApp(AsyncWebServerRequest *request) {
     
             if (LittleFS.exists(currentConfigFile)) {
                 loadConfig(currentConfigFile);
+                compileRequested = true;
                 Serial.println("Config loaded successfully.");
             } else {
                 Serial.println("ERROR: Config file not found in LittleFS!");
@@ -543,9 +2198,8 @@ void handleTeslaApp(AsyncWebServerRequest *request) {
             String val = request->getParam("show", true)->value();
             if (!val.startsWith("/")) val = "/" + val;
             currentShow = val;
-            if (fseqFile) fseqFile.close();
-            fseqFile = LittleFS.open(currentShow, "r");
-            if (fseqFile) readFseqHeader();
+            selectRequested = true;   // The show file is only touched by loop()
+            compileRequested = true;
         }
 
         // 3. Start Logic (Instant vs. Scheduled)
@@ -565,229 +2219,397 @@ void handleTeslaApp(AsyncWebServerRequest *request) {
         // 4. Analyzer Mode Toggle
         scanActive = request->hasParam("scan_mode", true);
 
+        // 5. Multi-Car Sync Role
+        if (request->hasParam("sync_role", true)) {
+            String role = request->getParam("sync_role", true)->value();
+            syncRole = role == "leader" ? SYNC_LEADER : (role == "follower" ? SYNC_FOLLOWER : SYNC_OFF);
+        }
+        // A follower joins the leader's show if it is already playing
+        followerJoinArmed = syncRole == SYNC_FOLLOWER;
+        uiStateChanged = true;
+
         request->redirect("/"); 
         return;
     }
 
-    // --- 3. UI GENERATION ---
-    String html = ""; 
-    html.reserve(8000); // Pre-allocate memory for performance
-
-    // HTML Header, CSS and Styles
-    html += R"=====(
-<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="viewport" content="width=device-width, initial-scale=1">
-<title>)=====";
-    html += PROJECT_NAME; 
-    html += R"=====(</title><style>
-:root { --tesla-red: #cc0000; --tesla-green: #2e7d32; --bg-dark: #121212; --card-bg: #1e1e1e; }
-body { font-family: 'Segoe UI', sans-serif; text-align: center; margin: 0; background: var(--bg-dark); color: #e0e0e0; padding: 15px; }
-.project-header { margin-bottom: 20px; opacity: 0.7; font-size: 0.8em; line-height: 1.4; letter-spacing: 0.5px; }
-.card { background: var(--card-bg); border-radius: 12px; padding: 20px; margin-bottom: 20px; max-width: 480px; margin-left: auto; margin-right: auto; border: 1px solid #333; box-shadow: 0 4px 15px rgba(0,0,0,0.5); }
-h1 { color: var(--tesla-red); letter-spacing: 2px; margin-bottom: 5px;  font-weight: 900; }
-h3 { border-bottom: 1px solid #333; padding-bottom: 10px; margin-top: 0; font-size: 1.1em; color: #bbb; }
-label { display: block; text-align: left; font-size: 0.85em; color: #888; margin: 10px 0 5px 0; }
-select, input, button { font-size: 16px; padding: 12px; margin: 5px 0; width: 100%; border-radius: 8px; border: 1px solid #333; background: #2a2a2a; color: white; box-sizing: border-box; outline: none; }
-select { appearance: none; background-image: url("data:image/svg+xml;charset=US-ASCII,%3Csvg%20xmlns%3D%22http%3A%2F%2Fwww.w3.org%2F2000%2Fsvg%22%20width%3D%22292.4%22%20height%3D%22292.4%22%3E%3Cpath%20fill%3D%22%23FFFFFF%22%20d%3D%22M287%2069.4a17.6%2017.6%200%200%200-13-5.4H18.4c-5%200-9.3%201.8-12.9%205.4A17.6%2017.6%200%200%200%200%2082.2c0%205%201.8%209.3%205.4%2012.9l128%20127.9c3.6%203.6%207.8%205.4%2012.8%205.4s9.2-1.8%2012.8-5.4L287%2095c3.5-3.5%205.4-7.8%205.4-12.8%200-5-1.9-9.2-5.5-12.8z%22%2F%3E%3C%2Fsvg%3E"); background-repeat: no-repeat; background-position: right 12px center; background-size: 12px auto; padding-right: 35px; }
-button { background: var(--tesla-red); cursor: pointer; font-weight: bold; border: none; text-transform: uppercase; letter-spacing: 1px; }
-.btn-now { background: var(--tesla-green); width: auto !important; padding: 12px 25px !important; margin-left: 5px; }
-.file-list { text-align: left; list-style: none; padding: 0; }
-.file-item { padding: 12px; border-bottom: 1px solid #252525; position: relative; }
-.btn-del { color: #ff4444; text-decoration: none; font-size: 11px; border: 1px solid #ff4444; padding: 3px 8px; border-radius: 4px; position: absolute; right: 10px; top: 12px; }
-.status-pill { display: inline-block; padding: 6px 18px; border-radius: 20px; font-weight: bold; margin-bottom: 20px; font-size: 0.9em; letter-spacing: 1px; }
-</style></head><body>)=====";
-
-    // --- Dynamic Project Branding ---
-    html += "<h1>" + String(PROJECT_NAME) + "</h1>";
-    html += "<div class='project-header'>";
-    html += "v" + String(PROJECT_VERSION) + " &bull; ESP32-C3 Lightshow Engine<br>";
-    html += "Built for Tesla Synchronized Performances</div>";
-
-    // --- UI: Dynamic Status Pill ---
-    String initialStatus = "⚪ NO CONFIG LOADED";
-    String pillColor = "#666"; 
-
-    if (showRunning) { 
-        initialStatus = "🔴 SHOW ACTIVE"; pillColor = "#d32f2f"; 
-    } else if (showStartEpoch > 0) { 
-        initialStatus = "⏳ WAITING..."; pillColor = "#f57c00"; 
-    } else if (configValid) { 
-        initialStatus = "🟢 READY"; pillColor = "#388e3c";
-    }
-
-    if (timeClient.getEpochTime() < 1000000) { 
-        initialStatus += " (⚠️ NO NTP SYNC)";
-        // We keep the color but add the text so they know why Countdown might fail
-    }
-
-    html += "<div id='status-pill' class='status-pill' style='background:" + pillColor + ";'>" + initialStatus + "</div>";
-
-    // --- MAIN CARD: Control Center ---
-    html += "<div class='card'><h3>Control Center</h3><form action='/setshow' method='post'>";
-    html += "<input type='hidden' id='utc_target' name='utc_target' value='0'>";
-
-    // 1. Show Selection
-    html += "<label>1. Select Sequence File:</label><select name='show'>";
-    html += cachedFseqOptions;
-    html += "</select>";
-
-    // 2. Hardware Config Mapping
-    html += "<label>2. Hardware Mapping:</label><select name='config' onchange='this.form.submit()'>";
-    html += cachedConfigOptions;
-    html += "</select>";
-
-    // 3. Timing and Launch
-    html += "<label>3. Start Time & Launch:</label><div style='display: flex; gap: 5px;'>";
-    html += "<select name='start_time' style='flex-grow: 1;'>";
-    time_t now = timeClient.getEpochTime();
-    for (int i = 1; i <= 10; i++) {
-        time_t optTime = now + (i * 60);
-        struct tm * t = localtime(&optTime);
-        char tStr[10];
-        sprintf(tStr, "%02d:%02d", t->tm_hour, t->tm_min);
-        html += "<option value='" + String(tStr) + "'>" + String(tStr) + "</option>";
-    }
-    html += "</select><button type='submit' name='instant' value='true' class='btn-now'>NOW</button></div>";
-
-    // 4. Mode Options
-    html += "<div style='text-align:left; margin-top:15px; margin-bottom:10px;'>";
-    html += "<input type='checkbox' id='scan_mode' name='scan_mode' value='true'" + String(scanActive ? " checked" : "") + " style='width:auto; margin-right:10px; vertical-align:middle;'>";
-    html += "<label for='scan_mode' style='display:inline; color:#888;'>Enable Channel Analyzer</label></div>";
-
-    html += "<button type='button' onclick='calculateUTCAndSync()' style='background:#444; margin-top:10px;'>START COUNTDOWN</button>";
-    html += "</form></div>";
-
-    // --- STORAGE EXPLORER CARD ---
-    html += "<div class='card'><h3>Storage Explorer</h3><ul class='file-list'>";
-    // Storage Info
-    html += "<div style='font-size:12px; color:#888; margin-bottom:10px; border-bottom:1px solid #eee; padding-bottom:5px;'>";
-    html += getStorageInfo(); 
-    html += "</div>";
-
-    html += "<ul class='file-list'>";
-
-    File explorerRoot = LittleFS.open("/");
-    File explorerFile = explorerRoot.openNextFile();
-    while (explorerFile) {
-        String n = explorerFile.name(); 
-        if (n.startsWith("/")) n = n.substring(1);
-        html += "<li class='file-item'><strong>" + n + "</strong>";
-        html += "<a href='/delete?file=" + n + "' class='btn-del' onclick='return confirm(\"Delete permanently?\")'>DELETE</a></li>";
-        explorerFile.close(); 
-        explorerFile = explorerRoot.openNextFile();
-    }
-    explorerRoot.close();
-    html += "</ul><hr style='border:0; border-top:1px solid #333; margin:20px 0;'>";
-    
-    // Upload Form
-    html += "<label>Upload (.json or .fseq):</label><form method='POST' action='/upload' enctype='multipart/form-data' style='text-align:left;'>";
-    html += "<input type='file' name='upload' accept='.json,.fseq' style='font-size:12px; border:1px dashed #555; width:100%;'>";
-    html += "<button type='submit' style='background:#444; margin-top:10px; font-size:14px;'>UPLOAD FILE</button></form>";
-    html += "<p><a href='/update' style='color:#388e3c; font-size:11px; text-decoration:none;'>&bull; Firmware OTA Portal</a></p></div>";
-
-    // --- JAVASCRIPT: Client-Side Logic ---
-    html += "<script>";
-    html += "var targetEpoch = " + String(showStartEpoch) + ";";
-    html += "var isRunning = " + String(showRunning ? "true" : "false") + ";";
-    
-    // Clean name extraction for display
-    String cleanName = currentConfigFile;
-    int lastSlash = cleanName.lastIndexOf('/');
-    if (lastSlash != -1) cleanName = cleanName.substring(lastSlash + 1);
-    if (cleanName == "None selected" || cleanName.length() < 2) cleanName = "None";
-    
-    html += "var configName = '" + cleanName + "';";
-    
-    html += R"=====(
-    function calculateUTCAndSync() {
-        const timeVal = document.getElementsByName("start_time")[0].value;
-        const showFile = document.getElementsByName("show")[0].value;
-        const configFile = document.getElementsByName("config")[0].value;
-        const scanMode = document.getElementById('scan_mode').checked;
-
-        const parts = timeVal.split(":");
-        let target = new Date(); 
-        target.setHours(parseInt(parts[0]), parseInt(parts[1]), 0, 0);
-        
-        // If time is in the past, assume it's for tomorrow
-        if (target.getTime() < Date.now()) { 
-            target.setDate(target.getDate() + 1); 
-        }
+    // --- 2. STATIC UI (gzipped, revalidated via ETag) ---
+    if (uiEtag.isEmpty()) {
+        // Filesystem image not flashed yet: minimal page to recover via upload/OTA
+        request->send(200, "text/html",
+            "<html><body style='font-family:Arial;background:#121212;color:white;padding:20px;'>"
+            "<h2>" PROJECT_NAME "</h2><p>Web UI missing (index.html.gz).</p>"
+            "<form method='POST' action='/upload' enctype='multipart/form-data'>"
+            "<input type='file' name='upload'><input type='submit' value='Upload'></form>"
+            "<p><a href='/update' style='color:#cc0000;'>Firmware Update (OTA)</a></p></body></html>");
+        return;
+    }
 
-        const targetEpoch = Math.floor(target.getTime() / 1000);
-        const browserNow = Math.floor(Date.now() / 1000);
-
-        // 1. First, send the selection (File/Config/Scan) via the normal POST
-        // We can use a FormData object to simulate the form submit in the background
-        const formData = new FormData();
-        formData.append('show', showFile);
-        formData.append('config', configFile);
-        if(scanMode) formData.append('scan_mode', 'true');
-
-        fetch('/setshow', { method: 'POST', body: formData })
-        .then(() => {
-            // 2. Immediately after, sync time and set the target
-            return fetch(`/start?target=${targetEpoch}&now=${browserNow}`);
-        })
-        .then(response => {
-            if (response.ok) {
-                // Success: Reload UI to show the "WAITING" status
-                location.reload();
-            } else {
-                alert("Sync Failed. Please try again.");
-            }
-        });
+    if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == uiEtag) {
+        request->send(304);
+        return;
     }
 
-    function updateCountdown() {
-        var now = Math.floor(Date.now() / 1000);
-        var pill = document.getElementById('status-pill');
-        if (isRunning) {
-            pill.innerHTML = "🔴 SHOW ACTIVE (" + configName + ")";
-            pill.style.background = "#d32f2f"; 
-            return;
+    // AsyncFileResponse picks up the .gz variant and sets Content-Encoding itself
+    AsyncWebServerResponse *response = request->beginResponse(LittleFS, "/index.html", "text/html");
+    response->addHeader("ETag", uiEtag);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
+/**
+ * Compact state snapshot for the static Web UI (GET /api/state).
+ * Serialized straight into the response stream: no HTML is assembled on the heap.
+ */
+void handleApiState(AsyncWebServerRequest *request) {
+    JsonDocument doc;
+    doc["version"]     = PROJECT_VERSION;
+    doc["running"]     = (bool)showRunning;
+    doc["startEpoch"]  = showStartEpoch;
+    doc["ntp"]         = timeClient.getEpochTime() >= 1000000;
+    doc["show"]        = currentShow.startsWith("/") ? currentShow.substring(1) : currentShow;
+    doc["config"]      = currentConfigFile.startsWith("/") ? currentConfigFile.substring(1) : currentConfigFile;
+    doc["configValid"] = configValid;
+    doc["scan"]        = scanActive;
+    doc["syncRole"]    = syncRole == SYNC_LEADER ? "leader" : (syncRole == SYNC_FOLLOWER ? "follower" : "off");
+    if (lastJoinTtffUs) {
+        JsonObject join = doc["join"].to<JsonObject>();
+        join["frame"]  = lastJoinFrame;
+        join["ttffMs"] = lastJoinTtffUs / 1000;
+    }
+    if (!playlist.empty()) {
+        JsonObject list = doc["playlist"].to<JsonObject>();
+        JsonArray items = list["items"].to<JsonArray>();
+        for (const PlaylistEntry& e : playlist) {
+            JsonObject item = items.add<JsonObject>();
+            item["show"]   = e.show.substring(1);
+            item["config"] = e.config.substring(1);
         }
-        if (targetEpoch > 0) {
-            var diff = targetEpoch - now;
-            if (diff > 0) {
-                pill.innerHTML = "⏳ START IN " + diff + " SECONDS";
-                pill.style.background = "#f57c00";
-            } else {
-                pill.innerHTML = "🚀 SHOW STARTING...";
-                pill.style.background = "#388e3c";
-                setTimeout(function(){ location.reload(); }, 2000);
+        list["pos"]      = playlistPos;
+        list["switches"] = playlistSwitches;
+        list["gapUs"]    = lastGapUs;      // Last switch: new show's first frame after the old one ended
+        list["maxGapUs"] = maxGapUs;
+    }
+    if (lastTimeSync.valid) {
+        JsonObject sync = doc["sync"].to<JsonObject>();
+        sync["rttUs"] = lastTimeSync.rttUs;   // Error bound of the sync is rtt / 2
+        if (lastSyncCheck.valid) sync["residualUs"] = lastSyncCheck.offsetUs;
+    }
+
+    JsonObject storage = doc["storage"].to<JsonObject>();
+    storage["used"]  = cachedFsUsed;
+    storage["total"] = cachedFsTotal;
+    if (showSlot.available()) {
+        JsonObject slot = doc["slot"].to<JsonObject>();
+        slot["capacity"] = showSlot.capacity() - SLOT_HEADER_SIZE;
+        if (showSlot.valid()) {
+            slot["show"] = showSlot.header().name + 1;   // Without leading slash, like "files"
+            slot["size"] = showSlot.header().length;
+        }
+    }
+
+    JsonArray shows    = doc["shows"].to<JsonArray>();
+    JsonArray configs  = doc["configs"].to<JsonArray>();
+    JsonArray files    = doc["files"].to<JsonArray>();
+    JsonArray analyzed = doc["analyzed"].to<JsonArray>();   // Shows with a channel report
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    response->addHeader("Cache-Control", "no-store");
+    {
+        FileIndexLock lock;   // Uploads and loop() change the records meanwhile
+        for (const FileRecord &f : fileIndex.records()) {
+            JsonObject item = files.add<JsonObject>();
+            item["name"] = f.name;
+            item["size"] = f.size;
+
+            if (f.kind == FILE_KIND_SHOW) {
+                shows.add(f.name);
+                if (fileIndex.find(analysisPath(String("/") + f.name).c_str())) analyzed.add(f.name);
+                if (f.frames) {
+                    item["frames"]   = f.frames;
+                    item["stepMs"]   = f.stepTimeMs;
+                    item["channels"] = f.channels;
+                    item["ms"]       = f.durationMs();
+                }
             }
-        } else {
-            if (configName === "None") {
-                pill.innerHTML = "⚪ NO CONFIG LOADED";
-                pill.style.background = "#666";
-            } else {
-                pill.innerHTML = "🟢 READY (" + configName + ")";
-                pill.style.background = "#388e3c";
+            else if (f.kind == FILE_KIND_CONFIG) {
+                configs.add(f.name);
+                item["label"] = f.label;
+                item["leds"]  = f.leds;
             }
         }
+
+        // The document points into the records: serialize before releasing them
+        serializeJson(doc, *response);
+    }
+    request->send(response);
+}
+
+/**
+ * ByteSink over a streamed HTTP response.
+ */
+class ResponseSink : public ByteSink {
+public:
+    explicit ResponseSink(AsyncResponseStream* response) : _response(response) {}
+    size_t write(const uint8_t* data, size_t len) override { return _response->write(data, len); }
+    bool seek(uint32_t) override { return false; }
+
+private:
+    AsyncResponseStream* _response;
+};
+
+/**
+ * Frame pipeline metrics in Prometheus text format (GET /metrics): stage
+ * and lateness histograms and frame counters since boot, plus the heap.
+ * Read while the tasks record, so a scrape may be one sample off.
+ */
+void handleMetrics(AsyncWebServerRequest *request) {
+    AsyncResponseStream *response = request->beginResponseStream("text/plain; version=0.0.4");
+    response->addHeader("Cache-Control", "no-store");
+    ResponseSink out(response);
+
+    pipelineMetrics.writePrometheus(out, "lightshow_stage_seconds",
+                                    "Time per frame pipeline stage (seek and read in the reader task)");
+    writePrometheusHeader(out, "lightshow_frame_lateness_seconds", "histogram", "Frame release after its deadline");
+    writePrometheusHistogram(out, "lightshow_frame_lateness_seconds", nullptr, frameLateness);
+
+    writePrometheusValue(out, "lightshow_frames_total", "counter", "Frames played", framesPlayed);
+    writePrometheusValue(out, "lightshow_frames_late_total", "counter",
+                         "Frames released more than 1 ms after their deadline", framesLate);
+    writePrometheusValue(out, "lightshow_frames_skipped_total", "counter", "Frames dropped by lag compensation",
+                         framesSkipped);
+    writePrometheusValue(out, "lightshow_ring_dropped_total", "counter", "Pre-read frames dropped from the ring",
+                         ringDroppedTotal);
+    writePrometheusValue(out, "lightshow_ring_underruns_total", "counter", "Frames the render path had to wait for",
+                         ringUnderrunsTotal);
+    writePrometheusValue(out, "lightshow_render_spin_microseconds_total", "counter",
+                         "Render task CPU time spent spinning for deadlines", renderSpinUsTotal);
+
+    writePrometheusValue(out, "lightshow_show_running", "gauge", "1 while a show plays", showRunning ? 1 : 0);
+    writePrometheusValue(out, "lightshow_heap_free_bytes", "gauge", "Free heap", ESP.getFreeHeap());
+    writePrometheusValue(out, "lightshow_heap_min_free_bytes", "gauge", "Lowest free heap since boot",
+                         ESP.getMinFreeHeap());
+    writePrometheusValue(out, "lightshow_heap_largest_block_bytes", "gauge", "Largest free heap block",
+                         heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+    request->send(response);
+}
+
+/**
+ * System (epoch) time in microseconds. Set from the browser, see /timesync.
+ */
+int64_t epochMicros() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+void setEpochMicros(int64_t us) {
+    struct timeval tv;
+    tv.tv_sec = us / 1000000;
+    tv.tv_usec = us % 1000000;
+    settimeofday(&tv, NULL);
+}
+
+/**
+ * One clock sync round (GET /time): receive and send timestamps in
+ * microseconds. The browser adds its own send/receive times.
+ */
+void handleTime(AsyncWebServerRequest *request) {
+    int64_t t2 = epochMicros();
+    char body[48];
+    snprintf(body, sizeof(body), "{\"t2\":%lld,\"t3\":%lld}", (long long)t2, (long long)epochMicros());
+    AsyncWebServerResponse *response = request->beginResponse(200, "application/json", body);
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+}
+
+/**
+ * Applies the browser's sync rounds (POST /timesync, s="t1,t2,t3,t4;...").
+ * apply=1 steps the system clock by the estimated offset; without it the
+ * offset is only measured and kept as the residual of the last sync.
+ */
+void handleTimeSync(AsyncWebServerRequest *request) {
+    if (!request->hasParam("s", true)) {
+        request->send(400, "text/plain", "Error: Missing sync samples");
+        return;
+    }
+    TimeSyncSample samples[TIME_SYNC_MAX_SAMPLES];
+    size_t n = parseTimeSyncSamples(request->getParam("s", true)->value().c_str(), samples, TIME_SYNC_MAX_SAMPLES);
+    TimeSyncResult result = estimateClockOffset(samples, n);
+    if (!result.valid) {
+        request->send(400, "text/plain", "Error: No usable sync samples");
+        return;
+    }
+
+    bool apply = request->hasParam("apply", true) && request->getParam("apply", true)->value() == "1";
+    if (apply) {
+        // Frames run on esp_timer: stepping the system clock never disturbs a running show
+        setEpochMicros(epochMicros() - result.offsetUs);
+        lastTimeSync = result;
+        lastSyncCheck = TimeSyncResult();
+        Serial.printf("Time Sync: offset %lld us, rtt %u us, %u/%u rounds\n",
+                      (long long)result.offsetUs, result.rttUs, result.used, (unsigned)n);
+    } else {
+        lastSyncCheck = result;
+        Serial.printf("Time Sync: residual %lld us (rtt %u us)\n", (long long)result.offsetUs, result.rttUs);
     }
-    setInterval(updateCountdown, 1000);
-    updateCountdown();
-    </script></body></html>)=====";
 
-    request->send(200, "text/html", html);
+    char body[96];
+    snprintf(body, sizeof(body), "{\"offsetUs\":%lld,\"rttUs\":%u,\"spreadUs\":%u,\"used\":%u}",
+             (long long)result.offsetUs, result.rttUs, result.spreadUs, result.used);
+    request->send(200, "application/json", body);
 }
 
+/**
+ * Pushes phase, countdown and playback progress to all /events clients.
+ * Runs in loop(): the message is formatted once into a stack buffer and
+ * handed to AsyncEventSource, which fans it out. The render task is never
+ * touched; it only reads the frame clock. Rate-limited per phase, phase
+ * changes go out immediately.
+ */
+void pushLiveStatus() {
+    static uint32_t lastPush = 0;
+    static const char* lastPhase = nullptr;
+
+    if (uiStateChanged) {
+        uiStateChanged = false;
+        if (events.count()) events.send("1", "state");
+    }
+
+    const char* phase = showRunning ? "run" : (showStartEpoch > 0 ? "wait" : "idle");
+    uint32_t interval = showRunning ? LIVE_STATUS_RUN_MS : LIVE_STATUS_WAIT_MS;
+    bool due = phase != lastPhase || liveStatusForce ||
+               (phase[0] != 'i' && millis() - lastPush >= interval);
+    if (!due) return;
+
+    lastPhase = phase;
+    lastPush = millis();
+    liveStatusForce = false;
+    if (!events.count()) return;
+
+    long left = showStartEpoch > 0 ? (long)showStartEpoch - (long)time(NULL) : 0;
+    uint32_t frame = 0, frames = 0;
+    if (showRunning) {
+        frame  = frameClock.current();
+        frames = fseq->info().frameCount;
+    }
+
+    char msg[112];
+    snprintf(msg, sizeof(msg),
+             "{\"phase\":\"%s\",\"left\":%ld,\"frame\":%u,\"frames\":%u,\"stepMs\":%u,\"skipped\":%u}",
+             phase, left < 0 ? 0L : left, (unsigned)frame, (unsigned)frames,
+             (unsigned)frameClock.stepTimeMs(), (unsigned)frameClock.skipped());
+    events.send(msg, "status", lastPush);
+}
+
+
+/**
+ * Outputs per show frame at render_hz, backing off while the LED wire time
+ * does not fit between two ticks.
+ */
+uint8_t blendSubsFor(uint16_t stepTimeMs) {
+    uint32_t subs = (uint32_t)stepTimeMs * currentConfig.render_hz / 1000;
+    uint8_t n = subs < 2 ? 1 : min(subs, (uint32_t)BLEND_MAX_SUBS);
+    while (n > 1 && currentConfig.wire_us >= stepTimeMs * 1000UL / n) n--;
+    return n;
+}
 
 /**
- * Opens the file and prepares everything for immediate playback.
+ * Opens the file and prepares everything for playback.
+ * Frame 0 is due at 'startUs' (engineMicros64 time base, 0 = right after
+ * the prefill). If that is too close or already past (late join), playback
+ * begins at the first frame still reachable after the seek and prefill,
+ * exactly on that frame's deadline.
  * Resets global trackers and OLED status.
  */
-void startShowSequence() {
+void startShowSequence(uint64_t startUs) {
+    uint64_t requestUs = engineMicros64();
     isBusy = true; 
-    if (fseqFile) { fseqFile.close(); fseqFile = File(); } 
+    followerJoinArmed = false;
+    stopFramePrefetch();
+    closeShowFile();
+    closeNextShow();
+    if (showSwitched) followPlaylistSwitch();
+    nextFailed = false;
+
+    // Prefer the flash slot, then the compiled sidecar; the analyzer needs the raw channels
+    playingSlot = !scanActive && openShowSlot();
+    playingSidecar = !playingSlot && !scanActive && openShowSidecar();
+    if (!playingSlot && !playingSidecar) showSource->open(currentShow);
+    compileLedMap(currentConfig.leds, ledMap, playingSidecar, &currentConfig.colors);
+
+    if (playingSlot || playingSidecar || readFseqHeader()) {
+        memset(globalMax, 0, sizeof(globalMax)); // Reset scan data for analyzer
+
+        // The analyzer watches every channel; otherwise fetch only the mapped ones
+        if (!scanActive && !currentConfig.readRanges.empty()) {
+            fseq->setReadRanges(currentConfig.readRanges);
+            if (fseq->bytesPerFrame() < fseq->info().stride) {
+                Serial.printf("Range reads: %u of %u bytes per frame in %u reads\n", fseq->bytesPerFrame(),
+                              fseq->info().stride, fseq->readsPerFrame());
+            }
+        }
+
+        // Power limit: precomputed per frame when the sidecar is there (the analyzer estimates)
+        if (scanActive || !loadPowerScales(currentShow, fseq->info().frameCount, powerScales)) {
+            powerScales.clear();
+            powerScales.shrink_to_fit();
+        }
+
+        // Interpolation: outputs per show frame at render_hz (the analyzer shows raw frames)
+        blendSubs = scanActive ? 1 : blendSubsFor(fseq->info().stepTimeMs);
+        blendSkipped = 0;
+        if (blendSubs > 1) {
+            Serial.printf("Interpolation: %u Hz, %u outputs per %u ms frame\n", currentConfig.render_hz, blendSubs,
+                          fseq->info().stepTimeMs);
+        }
 
-    fseqFile = LittleFS.open(currentShow, "r");
-    if (fseqFile && readFseqHeader()) {
+        // Output budget: every strip has to latch within a frame (interpolation backs off above)
+        if (currentConfig.wire_us >= fseq->info().stepTimeMs * 1000UL) {
+            Serial.printf("WARN: LED output needs %u us, frames are %u ms apart. Use more outputs or fewer LEDs.\n",
+                          currentConfig.wire_us, fseq->info().stepTimeMs);
+        }
+
+        // Late join: the frame due once seek and prefill are done (wrapping
+        // arithmetic, startUs may lie before boot)
+        uint32_t firstFrame = 0;
+        uint32_t stepUs = max((uint16_t)1, fseq->info().stepTimeMs) * 1000UL;
+        int64_t lateUs = startUs ? (int64_t)(requestUs + JOIN_LEAD_US - startUs) : 0;
+        if (lateUs > 0) {
+            uint64_t frame = ((uint64_t)lateUs + stepUs - 1) / stepUs;
+            if (frame >= fseq->info().frameCount) {
+                Serial.println(F("WARN: Scheduled show is already over."));
+                stopShowAndCleanup();
+                showStatus("SHOW OVER");
+                isBusy = false;
+                return;
+            }
+            firstFrame = frame;
+            Serial.printf("Late join: %lld ms after the start, seeking to frame %u\n",
+                          (long long)((lateUs - JOIN_LEAD_US) / 1000), firstFrame);
+        }
+
+        // Uncompressed from the flash slot: the LEDs read the mapped frames directly
+        // (a playlist needs the reader, it prefetches the next show into the ring)
+        zeroCopy = playingSlot && !playlistHasNext() && fseq->directFrame(firstFrame);
+        for (uint16_t i = 0; zeroCopy && i < ledMap.count; i++) zeroCopy = ledMap.src[i] < fseq->info().stride;
+        if (zeroCopy) {
+            Serial.println(F("Zero-copy playback from mapped flash."));
+        } else {
+            // Let the reader fill the ring before the clock starts
+            startFramePrefetch(firstFrame);
+            uint32_t prefill = min((uint32_t)FRAME_RING_DEPTH, fseq->info().frameCount - firstFrame);
+            unsigned long prefillStart = millis();
+            while (ringHead.load() < prefill && !readerFailed && millis() - prefillStart < 500) {
+                vTaskDelay(1);
+            }
+        }
+        showId = showIdFor(currentShow, fseq->info());
+        clockFollower.reset();
+        xQueueReset(beaconQueue);
+        joinRequestUs = firstFrame ? requestUs : 0;
+        frameClock.start(startUs ? startUs : engineMicros64(), fseq->info().stepTimeMs, firstFrame);
+        showEnded = false;
         showRunning = true;
-        currentFrame = 0; 
-        memset(globalMax, 0, sizeof(globalMax)); // Reset scan data for analyzer
-        showStartTimeMillis = millis(); 
+        xTaskNotifyGive(renderTaskHandle);
         
         u8g2.clearBuffer();
         u8g2.setFont(u8g2_font_logisoso18_tf);
@@ -802,19 +2624,159 @@ void startShowSequence() {
     isBusy = false;
 }
 
+/**
+ * True while the selected show is a playlist entry with another one after it.
+ */
+bool playlistHasNext() {
+    return playlistPos + 1 < (int)playlist.size() && playlist[playlistPos].show == currentShow &&
+           playlist[playlistPos].config == currentConfigFile;
+}
+
+/**
+ * Makes playlist entry 'pos' the selected show (loads its config if it
+ * differs). Not while a show plays.
+ */
+void selectPlaylistEntry(uint8_t pos) {
+    playlistPos = pos;
+    currentShow = playlist[pos].show;
+    if (playlist[pos].config != currentConfigFile) {
+        currentConfigFile = playlist[pos].config;
+        loadConfig(currentConfigFile);
+        compileRequested = true;
+    }
+    uiStateChanged = true;
+}
+
+/**
+ * Playlist: bookkeeping in loop() once the render task has switched to the
+ * next entry.
+ */
+void followPlaylistSwitch() {
+    showSwitched = false;
+    playlistPos++;
+    currentShow = playlist[playlistPos].show;
+    selectedShowId = showId;
+    nextFailed = false;
+    uiStateChanged = true;
+    Serial.printf("Playlist: %u/%u %s\n", playlistPos + 1, (unsigned)playlist.size(), currentShow.c_str());
+}
+
+/**
+ * Playlist: opens the next entry while the current one plays (sidecar or
+ * show file, read ranges, LED map, power scales, interpolation) and queues
+ * it for the reader, which prefetches its first frames right behind the
+ * current show's last one. Runs from loop(). An entry with another config
+ * cannot take over on the fly: it restarts once this show is over.
+ */
+void prepareNextShow() {
+    const PlaylistEntry& entry = playlist[playlistPos + 1];
+    if (entry.config != currentConfigFile) {
+        Serial.printf("Playlist: %s uses another config and starts after a restart.\n", entry.show.c_str());
+        nextFailed = true;
+        return;
+    }
+    unsigned long t0 = millis();
+
+    // 1. Compiled sidecar or the show file (the flash slot only serves the first show)
+    nextSidecar = openShowSidecar(entry.show, *nextFseq, *nextSource);
+    if (!nextSidecar && !(nextSource->open(entry.show) && nextFseq->open(nextSource))) {
+        Serial.printf("ERR: Playlist: %s: %s\n", entry.show.c_str(), nextFseq->lastError());
+        closeNextShow();
+        nextFailed = true;
+        return;
+    }
+    const FseqInfo& info = nextFseq->info();
+    if (!currentConfig.readRanges.empty()) nextFseq->setReadRanges(currentConfig.readRanges);
+
+    // 2. Its LED map, power scales and interpolation, swapped in at the boundary
+    nextLedSrc.assign(ledCount, 0);
+    nextLedColor.assign(ledCount, COLOR_OFF);
+    LedMapTable map = { nextLedSrc.data(), nextLedColor.data(), colorLuts.data(), ledCount };
+    compileLedMap(currentConfig.leds, map, nextSidecar, &currentConfig.colors);
+    loadPowerScales(entry.show, info.frameCount, nextPowerScales);
+    nextBlendSubs = blendSubsFor(info.stepTimeMs);
+    nextShowId = showIdFor(entry.show, info);
+
+    // 3. Queue it: the reader goes on with it after the last frame
+    readerNext.store(nextFseq, std::memory_order_release);
+    nextReady = true;
+    Serial.printf("Playlist: %s ready in %lu ms (%u frames)\n", entry.show.c_str(), millis() - t0, info.frameCount);
+}
+
+#ifdef MAPPING_BENCHMARK
+/**
+ * Boot-time microbenchmark: legacy branchy mapping vs. compiled LED map.
+ * Enable with -DMAPPING_BENCHMARK; results go to the Serial Monitor.
+ */
+void runMappingBenchmark() {
+    static const uint16_t sampleChannels[] = { 139, 164, 151, 152, 153, 154, 189, 192, 155, 158, 159, 160,
+                                               165, 142, 339, 364, 365, 370, 371, 390, 391, 392, 184, 380, 342 };
+    static const uint16_t sizes[] = { 25, 100, 1000 };
+    const uint16_t rounds = 1000;
+
+    static uint8_t frame[LOGICAL_CHANNELS];
+    for (int i = 0; i < LOGICAL_CHANNELS; i++) frame[i] = (i * 37) & 0xFF;
+
+    for (uint16_t n : sizes) {
+        std::vector<LedMapping> mapping(n);
+        for (uint16_t i = 0; i < n; i++) mapping[i].channel = sampleChannels[i % 25];
+
+        std::vector<CRGB> out(n);
+        std::vector<uint16_t> src(n);
+        std::vector<uint8_t> color(n);
+        LedMapTable map = { src.data(), color.data(), defaultColorLuts(), n };
+        compileLedMap(mapping, map);
+
+        // Legacy kernel (per-LED channel classification)
+        unsigned long t0 = micros();
+        for (uint16_t r = 0; r < rounds; r++) {
+            for (uint16_t i = 0; i < n; i++) {
+                uint16_t rawCh = mapping[i].channel;
+                if (rawCh == 9999) { out[i] = CRGB::Black; continue; }
+                uint8_t val = (rawCh < 1024) ? frame[rawCh] : 0;
+                if (rawCh == 139 || rawCh == 142 || rawCh == 339 || rawCh == 342) out[i] = CRGB(val, (val * 160) >> 8, 0);
+                else if ((rawCh >= 364 && rawCh <= 371) || rawCh == 392) out[i] = CRGB(val, 0, 0);
+                else if (rawCh >= 151 && rawCh <= 160) out[i] = CRGB((val * 100) >> 8, (val * 100) >> 8, val);
+                else out[i] = CRGB(val, val, val);
+            }
+        }
+        unsigned long legacyUs = micros() - t0;
+
+        // Compiled kernel
+        t0 = micros();
+        for (uint16_t r = 0; r < rounds; r++) mapFrameToLeds(frame, map, out.data());
+        unsigned long compiledUs = micros() - t0;
+
+        Serial.printf("BENCH map %4u LEDs: legacy %6.2f us/frame | compiled %6.2f us/frame\n",
+                      n, legacyUs / (float)rounds, compiledUs / (float)rounds);
+    }
+}
+#endif
+
 // ------------------- setup & loop -------------------
 void setup() {
   Serial.begin(115200);
   delay(1000);
   Serial.println("=== myS3XY Lightshow starting ===");
+#ifdef MAPPING_BENCHMARK
+  runMappingBenchmark();
+#endif
 
   WiFi.setSleep(false); // to prevent sleep modes
 
   pinMode(STATUS_LED, OUTPUT);
   digitalWrite(STATUS_LED, HIGH); // blue LED off = WiFi not connected
 
-  FastLED.addLeds<WS2812B, DATA_PIN, GRB>(leds, MAX_LEDS).setCorrection(TypicalLEDStrip);  // Fixed to DATA_PIN, buffer MAX_LEDS
-  applyPowerSettings();
+  applyPowerSettings();     // LED strips are set up by loadConfig()
+
+  // Frame reader runs above loop() but below AsyncTCP; the render task above both
+  beaconQueue = xQueueCreate(4, sizeof(BeaconRx));
+  xTaskCreate(frameReaderTask, "fseqReader", 4096, nullptr, READER_TASK_PRIORITY, &readerTaskHandle);
+  xTaskCreate(renderTask, "render", 4096, nullptr, RENDER_TASK_PRIORITY, &renderTaskHandle);
+  esp_timer_create_args_t wakeArgs = {};
+  wakeArgs.callback = wakeRenderTask;
+  wakeArgs.name = "renderWake";
+  esp_timer_create(&wakeArgs, &renderWake);
 
   u8g2.begin();
   u8g2.setContrast(255);
@@ -838,7 +2800,6 @@ void setup() {
   if (WiFi.status() == WL_CONNECTED) {
     digitalWrite(STATUS_LED, LOW); // Blue LED ON
     showStatus("WiFi OK");
-    showIP();
 
     // --- 2. mDNS Setup (Only if WiFi is OK) ---
     if (MDNS.begin("mys3xy")) {
@@ -882,7 +2843,15 @@ void setup() {
   }
   Serial.println("LittleFS mounted");
   // IMPORTANT: Populate the UI cache immediately after mounting
-  refreshFileCache();
+  if (LittleFS.exists(UPLOAD_TMP)) LittleFS.remove(UPLOAD_TMP); // Leftover of an interrupted upload
+  fileIndexMutex = xSemaphoreCreateMutex();
+  conversionMutex = xSemaphoreCreateMutex();
+  loadFileIndex();
+  refreshUiEtag();
+  if (showSlot.begin()) {
+      Serial.printf("Flash slot: %u KB, %s\n", showSlot.capacity() / 1024,
+                    showSlot.valid() ? showSlot.header().name : "empty");
+  }
 
   // --- Storage Capacity Check ---
     if (LittleFS.begin(true)) {
@@ -901,40 +2870,32 @@ void setup() {
         Serial.println(F("----------------------"));
     }
 
-    // --- Auto-Discovery for Config & Show ---
-    File rootDir = LittleFS.open("/");
-    File fileEntry = rootDir.openNextFile();
-    while (fileEntry) {
-        String n = fileEntry.name();
-        if (!n.startsWith("/")) n = "/" + n; // Normalize for LittleFS
-        
+    // --- Auto-Discovery for Config & Show (from the file index) ---
+    for (const FileRecord& r : fileIndex.records()) {
+        String n = String("/") + r.name;
+
         // Auto-load first config
-        if (currentConfigFile == "None selected" && n.indexOf("config_") != -1 && n.endsWith(".json")) {
+        if (currentConfigFile == "None selected" && r.kind == FILE_KIND_CONFIG) {
             currentConfigFile = n;
             if (loadConfig(currentConfigFile)) {
                 Serial.printf("Auto-loaded config: %s\n", n.c_str());
             }
         }
         // Auto-select first show
-        if (currentShow == "None selected" && n.endsWith(".fseq")) {
+        if (currentShow == "None selected" && r.kind == FILE_KIND_SHOW) {
             currentShow = n;
             Serial.printf("Auto-selected show: %s\n", n.c_str());
         }
-        fileEntry = rootDir.openNextFile();
     }
-    rootDir.close();
 
   // List all files
-  File root = LittleFS.open("/");
-  File file = root.openNextFile();
-  while (file) {
-    Serial.println("Found file: " + String(file.name()));
-    file = root.openNextFile();
+  for (const FileRecord& r : fileIndex.records()) {
+    Serial.printf("Found file: %s (%u bytes)\n", r.name, r.size);
   }
-  root.close();
 
   if (currentConfigFile.startsWith("/")) {
     loadConfig(currentConfigFile);
+    compileRequested = true; // Builds the sidecar once loop() runs, if missing or stale
   } else {
     Serial.println(F("No default config selected yet."));
   }
@@ -949,75 +2910,27 @@ void setup() {
   ElegantOTA.begin(&server);
   server.on("/", HTTP_ANY, handleTeslaApp);
   server.on("/", HTTP_GET, handleTeslaApp);
-  server.on("/setshow", HTTP_GET, handleTeslaApp);
+  server.on("/setshow", HTTP_GET, [](AsyncWebServerRequest *request) { request->redirect("/"); });
   server.on("/setshow", HTTP_POST, handleTeslaApp);
   server.on("/delete", HTTP_GET, handleDelete);
+  server.on("/api/state", HTTP_GET, handleApiState);
+  server.on("/metrics", HTTP_GET, handleMetrics);
+  server.on("/time", HTTP_GET, handleTime);
+  server.on("/timesync", HTTP_POST, handleTimeSync);
+  events.onConnect([](AsyncEventSourceClient *client) { liveStatusForce = true; });
+  server.addHandler(&events);
   // --- HTTP POST: File Upload Handler ---
-  server.on("/upload", HTTP_POST, [](AsyncWebServerRequest *request) {
-      bool isValid = true;
-      String message = "Upload successful!";
-      
-      // Validation: Check if the uploaded JSON is syntactically correct
-      if (lastUploadedFilename.endsWith(".json")) {
-          File file = LittleFS.open("/" + lastUploadedFilename, "r");
-          if (file) {
-              JsonDocument doc;
-              DeserializationError error = deserializeJson(doc, file);
-              file.close();
-              if (error) {
-                  isValid = false;
-                  message = "JSON ERROR: " + String(error.c_str());
-                  LittleFS.remove("/" + lastUploadedFilename); // Delete invalid file
-              }
-          }
-      }
-
-      // UI: Feedback page with Tesla-style status colors
-      String statusColor = isValid ? "#4CAF50" : "#f44336";
-      String html = "<html><head><meta name='viewport' content='width=device-width, initial-scale=1'></head>";
-      html += "<body style='font-family:Arial;text-align:center;background:#121212;color:white;padding:20px;'>";
-      html += "<div style='background:#1e1e1e;padding:30px;border-radius:12px;border-top:5px solid " + statusColor + ";display:inline-block;width:90%;max-width:400px;'>";
-      html += "<h2>" + message + "</h2>";
-      html += "<p style='color:#888;'>File: " + lastUploadedFilename + "</p>";
-      html += "<br><a href='/' style='display:block;background:#cc0000;color:white;padding:15px;text-decoration:none;border-radius:6px;font-weight:bold;'>[ Back to Dashboard ]</a>";
-      html += "</div></body></html>";
-      
-      request->send(200, "text/html", html);
-  }, [](AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final) {
-      // Chunked Upload: Process incoming data packets
-      if (!index) {
-          // New upload starts: sanitize filename
-          if (filename.startsWith("/")) lastUploadedFilename = filename.substring(1);
-          else lastUploadedFilename = filename;
-          
-          Serial.printf("Uploading: %s\n", lastUploadedFilename.c_str());
-          request->_tempFile = LittleFS.open("/" + lastUploadedFilename, "w");
-      }
-      
-      if (len && request->_tempFile) {
-          request->_tempFile.write(data, len);
-          yield(); // Give ESP32-C3 time for background tasks (WiFi/WDT)
-      }
-      
-      if (final && request->_tempFile) {
-          request->_tempFile.close();
-          refreshFileCache(); 
-          Serial.println(F("Upload complete & Cache refreshed."));
-          yield();
-      }
-  });
+  server.on("/upload", HTTP_POST, handleUploadDone, handleUploadChunk);
+  server.on("/analyze", HTTP_POST, handleAnalyze);
+  server.on("/analysis", HTTP_GET, handleAnalysis);
+  server.on("/slot", HTTP_POST, handleSlot);
+  server.on("/playlist", HTTP_POST, handlePlaylist);
 
   server.on("/cancel", HTTP_GET, [](AsyncWebServerRequest *request) {
-    showRunning = false;
+    followerJoinArmed = false;
     showStartEpoch = 0;
     triggerCountdown = false;
-    currentFrame = 0;
-    FastLED.clear();
-    FastLED.show();
-    u8g2.clearBuffer();
-    u8g2.setFont(u8g2_font_6x10_tr);
-    u8g2.drawStr(xOffset, yOffset + 20, "Show Cancelled");
-    u8g2.sendBuffer();
+    cancelRequested = true;   // Stopping and closing the files is up to loop()
     request->redirect("/"); // Back to the Dashboard
   });
 
@@ -1025,23 +2938,28 @@ void setup() {
   // This endpoint synchronizes the ESP32 internal clock with the browser's time
   // and sets the target epoch for the show start.
   server.on("/start", HTTP_GET, [](AsyncWebServerRequest *request) {
-      if (request->hasParam("target") && request->hasParam("now")) {
+      // Stopping a running show is up to /cancel (loop() owns the stop handshake)
+      if (showRunning || prefetchActive || readerBusy) {
+          request->send(409, "text/plain", "Show in progress.");
+          return;
+      }
+      if (request->hasParam("target")) {
           // 1. Extract timestamps from URL parameters
           uint32_t targetTime = request->getParam("target")->value().toInt();
-          uint32_t browserNow = request->getParam("now")->value().toInt();
           
-          // 2. Sync ESP32 system time with browser time (bypass NTP lag)
-          struct timeval tv;
-          tv.tv_sec = browserNow;
-          tv.tv_usec = 0;
-          settimeofday(&tv, NULL); 
+          // 2. Legacy clients: whole-second sync with browser time (the
+          //    current UI syncs beforehand via /time + /timesync)
+          if (request->hasParam("now")) {
+              uint32_t browserNow = request->getParam("now")->value().toInt();
+              setEpochMicros((int64_t)browserNow * 1000000);
+              Serial.printf("Time Sync (legacy): System=%u\n", browserNow);
+          }
           
           // 3. Set global variables to trigger the countdown in loop()
           showStartEpoch = targetTime;
           triggerCountdown = true;
-          showRunning = false; // Wait for countdown to finish
           
-          Serial.printf("Time Sync: System=%u, StartAt=%u\n", browserNow, targetTime);
+          Serial.printf("Show scheduled: StartAt=%u\n", targetTime);
           request->send(200, "text/plain", "Sync Success");
       } else {
           request->send(400, "text/plain", "Error: Missing time parameters");
@@ -1050,7 +2968,24 @@ void setup() {
 
   server.begin();
   Serial.println("Web server & OTA ready");
-  showStatus("App ready");
+
+  // Multi-car sync: followers queue matching beacons for the render task
+  // (or, while idle and armed, for a late join in loop())
+  if (beaconUdp.listen(BEACON_PORT)) {
+    beaconUdp.onPacket([](AsyncUDPPacket &packet) {
+      if (syncRole != SYNC_FOLLOWER || (!showRunning && !followerJoinArmed)) return;
+      BeaconRx rx;
+      rx.rxUs = engineMicros64();
+      if (!decodeBeacon(packet.data(), packet.length(), rx.beacon)) return;
+      if (rx.beacon.showId != (showRunning ? showId : selectedShowId)) return;
+      xQueueSend(beaconQueue, &rx, 0);
+    });
+  } else {
+    Serial.println(F("WARN: Sync beacon port unavailable, multi-car sync disabled."));
+  }
+  // IP stays on the OLED until the first countdown or show
+  if (WiFi.status() == WL_CONNECTED) showIP();
+  else showStatus("App ready");
 }
 
 /**
@@ -1072,7 +3007,9 @@ void logSystemHealth() {
     Serial.printf("Fragmentation (Largest Block): %u Bytes\n", maxBlock);
     
     if (showRunning) {
-        Serial.printf("Active Show: Frame %u / %u\n", currentFrame, frameCount);
+        Serial.printf("Active Show: Frame %u / %u\n", frameClock.current(), fseq->info().frameCount);
+        Serial.printf("Prefetch Ring: %u underruns, %u dropped (depth %d)\n",
+                      ringUnderruns, ringDropped, FRAME_RING_DEPTH);
     }
 
     // Warnung bei kritischem Speicherstand
@@ -1085,11 +3022,72 @@ void logSystemHealth() {
 void loop() {
   logSystemHealth(); 
   ElegantOTA.loop();
+  pushLiveStatus();
+  sendSyncBeacon();
   
   // We use the internal system clock (synced via /start)
   time_t now;
   time(&now); 
 
+  // --- WEB REQUESTS (the show files are only opened and closed here) ---
+  if (cancelRequested && !isBusy) {
+      cancelRequested = false;
+      stopShowAndCleanup();
+      showEnded = false;   // A cancelled show must not advance the playlist
+      u8g2.clearBuffer();
+      u8g2.setFont(u8g2_font_6x10_tr);
+      u8g2.drawStr(xOffset, yOffset + 20, "Show Cancelled");
+      u8g2.sendBuffer();
+  }
+  if (selectRequested && !showRunning && !isBusy) {
+      selectRequested = false;
+      closeShowFile();
+      if (showSource->open(currentShow) && readFseqHeader()) selectedShowId = showIdFor(currentShow, fseq->info());
+      uiStateChanged = true;
+  }
+
+  // --- CASE 0: SHOW CONVERTER, ANALYZER & COMPILER (only while nothing is scheduled) ---
+  if (!showRunning && !triggerCountdown && showStartEpoch == 0 && !isBusy) {
+      String queued;
+      if (takeConversion(queued)) {
+          convertShowToDelta(queued);
+      }
+      else if (pendingAnalysis.length() > 0) {
+          String src = pendingAnalysis;
+          pendingAnalysis = "";
+          analyzeShowFile(src);
+      }
+      else if (pendingSlotWrite.length() > 0) {
+          String src = pendingSlotWrite;
+          pendingSlotWrite = "";
+          writeShowSlot(src);
+      }
+      else if (compileRequested) {
+          compileRequested = false;
+          compileShowSidecar(currentShow);
+          compilePowerSidecar(currentShow);
+          // Playlist entries on the same config switch gaplessly from their sidecars too
+          for (size_t i = 0; i < playlist.size(); i++) {
+              if (playlist[i].config != currentConfigFile || playlist[i].show == currentShow) continue;
+              compileShowSidecar(playlist[i].show);
+              compilePowerSidecar(playlist[i].show);
+          }
+      }
+      else if (indexIncomplete) {
+          // Shows stored during playback: parse their headers now
+          indexIncomplete = false;
+          std::vector<String> shows;
+          {
+              FileIndexLock lock;
+              for (const FileRecord& r : fileIndex.records()) {
+                  if (r.kind == FILE_KIND_SHOW && r.frames == 0) shows.push_back(String("/") + r.name);
+              }
+          }
+          for (const String& n : shows) indexFile(n);
+          saveFileIndex();
+      }
+  }
+
   // --- CASE 1: TRIGGER IMMEDIATE START (NOW) ---
   if (triggerCountdown && showStartEpoch == 0 && !showRunning) {
       Serial.println(F("Instant start triggered (NOW button)."));
@@ -1099,10 +3097,11 @@ void loop() {
 
   // --- CASE 2: WAITING FOR SCHEDULED START (COUNTDOWN) ---
   if (showStartEpoch > 0 && !showRunning) {
-    time_t now = time(NULL); // System time synced via smartphone
-    long secondsLeft = showStartEpoch - now;
+    // System time synced via smartphone (microseconds, see /timesync)
+    int64_t usLeft = (int64_t)showStartEpoch * 1000000 - epochMicros();
+    long secondsLeft = (usLeft + 999999) / 1000000;
 
-    if (secondsLeft > 0) {
+    if (usLeft > START_LEAD_US) {
       // --- DISPLAY COUNTDOWN (Original Tesla Style) ---
       static unsigned long lastUpdate = 0;
       if (millis() - lastUpdate > 500) { 
@@ -1126,60 +3125,50 @@ void loop() {
         lastUpdate = millis();
       }
     } 
-    // --- TRIGGER START ---
-    else if (secondsLeft >= -2) {
-        showStartEpoch = 0;
-        triggerCountdown = false; 
-        startShowSequence(); 
-    } 
+    // --- TRIGGER START (late: joins mid-show at the correct frame) ---
     else {
-        // Sync Error logic
-        stopShowAndCleanup();
-        showStatus("SYNC ERROR");
-        delay(2000);
+        // Pin frame 0 to the target instant; the prefill runs inside the lead time
+        uint64_t startUs = engineMicros64() + (uint64_t)usLeft;
         showStartEpoch = 0;
-        triggerCountdown = false;
+        triggerCountdown = false; 
+        startShowSequence(startUs ? startUs : 1); 
     }
   }
 
-  // --- CASE 3: SHOW IS ACTIVE ---
-  if (showRunning && !isBusy) {
-      static uint32_t totalProcessTime = 0;
-      static uint16_t sampleCounter = 0;
-      
-      // 1. High precision frame timing
-      unsigned long msElapsed = millis() - showStartTimeMillis;
-      uint32_t targetFrame = msElapsed / stepTimeMs;
-
-      // 2. Playback logic
-      if (targetFrame >= currentFrame) {
-          // Automatic lag compensation
-          if (targetFrame > currentFrame + 2) {
-              currentFrame = targetFrame;
-          }
-
-          unsigned long startMicros = micros();
-          
-          if (!playFrame(currentFrame)) {
-              stopShowAndCleanup();
-          } else {
-              currentFrame++;
-          }
+  // --- CASE 2b: FOLLOWER LATE JOIN (the leader is already playing) ---
+  BeaconRx rx;
+  if (followerJoinArmed && !showRunning && !isBusy && showStartEpoch == 0 &&
+      xQueueReceive(beaconQueue, &rx, 0) == pdTRUE) {
+      Serial.printf("Follower: leader at frame %u, joining.\n", rx.beacon.frame);
+      uint64_t startUs = rx.rxUs - (uint64_t)rx.beacon.showTimeUs;
+      startShowSequence(startUs ? startUs : 1);
+  }
 
-          // Calculate and monitor performance
-          uint32_t duration = (micros() - startMicros) / 1000;
-          totalProcessTime += duration;
-          sampleCounter++;
+  // --- CASE 2c: PLAYLIST (next entry opened while the current one plays) ---
+  if (showSwitched && readerSegment == renderSegment && !isBusy) {
+      closeNextShow();   // The finished show: the reader has moved on
+      followPlaylistSwitch();
+  }
+  if (showRunning && !showSwitched && !nextReady && !nextFailed && !scanActive && !isBusy && playlistHasNext()) {
+      prepareNextShow();
+  }
 
-          if (sampleCounter >= 100) {
-              uint32_t avg = totalProcessTime / 100;
-              Serial.printf(">>> PERFORMANCE: Avg Frame Time %d ms | Target: %d ms\n", avg, stepTimeMs);
-              if (avg >= stepTimeMs) {
-                  Serial.println("!!! WARNING: Storage or CPU too slow!");
-              }
-              totalProcessTime = 0;
-              sampleCounter = 0;
-          }
+  // --- CASE 3: SHOW FINISHED (frames are played by renderTask) ---
+  if (showEnded && !isBusy) {
+      showEnded = false;
+      // Playlist without a gapless switch (other config, next show not ready): restart on the next entry
+      bool finished = !readerFailed && frameClock.current() + 1 >= fseq->info().frameCount;
+      uint64_t endUs = frameClock.deadline(fseq->info().frameCount);
+      bool hasNext = finished && !scanActive && playlistHasNext();
+      bool lastEntry = finished && !hasNext && playlistPos > 0 && playlistPos < playlist.size() &&
+                       playlist[playlistPos].show == currentShow;
+      stopShowAndCleanup();
+      if (hasNext) {
+          selectPlaylistEntry(playlistPos + 1);
+          transitionUs = endUs;
+          startShowSequence();
+      } else if (lastEntry) {
+          selectPlaylistEntry(0);   // Ready to play the list again
       }
   }
 }
\ No newline at end of file
@@ -0,0 +1,159 @@
+/**
+ * =====================================================================
+ * myS3XY-Lightshow: synthetic shows for the native tests and the bench
+ * =====================================================================
+ * Builds FSEQ files in memory (V1, V2 with zlib blocks, V2 sparse) from
+ * show-like channel data, so every format can be compared against the
+ * same expected frames. Header-only: each test suite is its own program.
+ * =====================================================================
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <zlib.h>
+#include "FseqReader.h"
+
+#define FIXTURE_CHANNELS 512
+#define FIXTURE_FRAMES   3000     // 60 s at 20 ms
+#define FIXTURE_STEP_MS  20
+#define FIXTURE_BLOCK    128      // Frames per zlib block
+
+struct Rgb {
+  uint8_t r, g, b;
+};
+
+// Channels of examples/config_all_25,json
+static const uint16_t sampleChannels[] = { 139, 164, 151, 152, 153, 154, 189, 192, 155, 158, 159, 160,
+                                           165, 142, 339, 364, 365, 370, 371, 390, 391, 392, 184, 380, 342 };
+
+inline void putLe16(std::vector<uint8_t>& v, size_t at, uint32_t x) {
+    v[at] = x & 0xFF; v[at + 1] = (x >> 8) & 0xFF;
+}
+
+inline void putLe24(std::vector<uint8_t>& v, size_t at, uint32_t x) {
+    putLe16(v, at, x & 0xFFFF); v[at + 2] = (x >> 16) & 0xFF;
+}
+
+inline void putLe32(std::vector<uint8_t>& v, size_t at, uint32_t x) {
+    putLe16(v, at, x & 0xFFFF); putLe16(v, at + 2, x >> 16);
+}
+
+/**
+ * Show-like channel data: mostly dark, with blinking indicators, ramps
+ * on a few channel groups and a flickering matrix section.
+ */
+inline std::vector<uint8_t> makeFrames(uint32_t frames, uint32_t channels) {
+    std::vector<uint8_t> data((size_t)frames * channels, 0);
+    srand(42);
+    for (uint32_t f = 0; f < frames; f++) {
+        uint8_t* fr = data.data() + (size_t)f * channels;
+        for (uint32_t c = 0; c < channels; c++) {
+            uint32_t group = c / 16;
+            uint32_t phase = (f + group * 7) % 200;
+            if (group % 5 == 0) fr[c] = ((f / 25) & 1) ? 255 : 0;                // Blink
+            else if (group % 5 == 1) fr[c] = phase < 100 ? phase * 255 / 100 : 0; // Ramp
+            else if (group % 5 == 2 && (f / 50) % 3 == 0) fr[c] = rand() & 0xFF;  // Flicker
+        }
+    }
+    return data;
+}
+
+/**
+ * FSEQ V1, dense.
+ */
+inline std::vector<uint8_t> buildV1(const std::vector<uint8_t>& frames, uint32_t channels, uint32_t count) {
+    std::vector<uint8_t> f(28 + frames.size(), 0);
+    memcpy(f.data(), "PSEQ", 4);
+    putLe16(f, 4, 28);
+    f[6] = 0; f[7] = 1;
+    putLe16(f, 8, 28);
+    putLe32(f, 10, channels);
+    putLe32(f, 14, count);
+    putLe16(f, 18, FIXTURE_STEP_MS);
+    memcpy(f.data() + 28, frames.data(), frames.size());
+    return f;
+}
+
+/**
+ * FSEQ V2 with optional zlib blocks, sparse ranges and an 'mf' header.
+ * 'frames' holds the physical frames (only the channels of the ranges).
+ */
+inline std::vector<uint8_t> buildV2(const std::vector<uint8_t>& frames, uint32_t stride, uint32_t count,
+                                    bool zlib, const std::vector<std::pair<uint32_t, uint32_t>>& ranges) {
+    std::vector<std::vector<uint8_t>> blocks;
+    std::vector<uint32_t> blockFirst;
+    if (zlib) {
+        for (uint32_t f = 0; f < count; f += FIXTURE_BLOCK) {
+            uint32_t n = std::min((uint32_t)FIXTURE_BLOCK, count - f);
+            uLongf len = compressBound(n * stride);
+            std::vector<uint8_t> out(len);
+            compress2(out.data(), &len, frames.data() + (size_t)f * stride, n * stride, 6);
+            out.resize(len);
+            blocks.push_back(out);
+            blockFirst.push_back(f);
+        }
+    }
+
+    const char media[] = "show.mp3";
+    uint32_t varStart = 32 + blocks.size() * 8 + ranges.size() * 6;
+    uint32_t varLen = 4 + sizeof(media);
+    uint32_t dataOffset = (varStart + varLen + 3) & ~3u;
+
+    std::vector<uint8_t> f(dataOffset, 0);
+    memcpy(f.data(), "PSEQ", 4);
+    putLe16(f, 4, dataOffset);
+    f[6] = 0; f[7] = 2;
+    putLe16(f, 8, varStart);
+    putLe32(f, 10, stride);
+    putLe32(f, 14, count);
+    f[18] = FIXTURE_STEP_MS;
+    f[20] = (zlib ? FSEQ_COMPRESSION_ZLIB : FSEQ_COMPRESSION_NONE) | ((blocks.size() >> 4) & 0xF0);
+    f[21] = blocks.size() & 0xFF;
+    f[22] = ranges.size();
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        putLe32(f, 32 + i * 8, blockFirst[i]);
+        putLe32(f, 36 + i * 8, blocks[i].size());
+    }
+    for (size_t i = 0; i < ranges.size(); i++) {
+        size_t at = 32 + blocks.size() * 8 + i * 6;
+        putLe24(f, at, ranges[i].first);
+        putLe24(f, at + 3, ranges[i].second);
+    }
+    putLe16(f, varStart, varLen);
+    f[varStart + 2] = 'm'; f[varStart + 3] = 'f';
+    memcpy(f.data() + varStart + 4, media, sizeof(media));
+
+    if (zlib) {
+        for (const std::vector<uint8_t>& b : blocks) f.insert(f.end(), b.begin(), b.end());
+    } else {
+        f.insert(f.end(), frames.begin(), frames.end());
+    }
+    return f;
+}
+
+/**
+ * Sparse V2 show of 'frames' (FIXTURE_CHANNELS wide): two ranges (0-199
+ * and 300-511), physically packed. 'expect' receives the logical frames
+ * it decodes to (channels outside the ranges stay black).
+ */
+inline std::vector<uint8_t> buildSparse(const std::vector<uint8_t>& frames, uint32_t count,
+                                        std::vector<uint8_t>& expect) {
+    std::vector<std::pair<uint32_t, uint32_t>> ranges = { { 0, 200 }, { 300, 212 } };
+    const uint32_t stride = 412;
+    std::vector<uint8_t> packed((size_t)count * stride);
+    expect.assign((size_t)count * FIXTURE_CHANNELS, 0);
+    for (uint32_t f = 0; f < count; f++) {
+        const uint8_t* src = frames.data() + (size_t)f * FIXTURE_CHANNELS;
+        memcpy(packed.data() + (size_t)f * stride, src, 200);
+        memcpy(packed.data() + (size_t)f * stride + 200, src + 300, 212);
+        memcpy(expect.data() + (size_t)f * FIXTURE_CHANNELS, src, 200);
+        memcpy(expect.data() + (size_t)f * FIXTURE_CHANNELS + 300, src + 300, 212);
+    }
+    return buildV2(packed, stride, count, false, ranges);
+}
@@ -0,0 +1,70 @@
+/**
+ * ChannelAnalyzer: per-channel peaks, lit frames, toggles and histogram
+ * against a direct count, and the JSON report around them.
+ */
+#include <unity.h>
+#include <string>
+#include "../ShowFixtures.h"
+#include "ChannelAnalyzer.h"
+
+static std::vector<uint8_t> frames, v2z;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_stats_match_direct_count(void) {
+    MemorySource src(v2z.data(), v2z.size());
+    FseqReader reader;
+    TEST_ASSERT_TRUE(reader.open(&src));
+    ChannelAnalysis analysis;
+    TEST_ASSERT_TRUE(analyzeChannels(reader, analysis));
+    TEST_ASSERT_EQUAL_UINT32(FIXTURE_FRAMES, analysis.frames);
+    TEST_ASSERT_EQUAL_UINT16(FIXTURE_STEP_MS, analysis.stepTimeMs);
+
+    for (uint16_t ch = 0; ch < ANALYZER_CHANNELS && ch < FIXTURE_CHANNELS; ch++) {
+        uint8_t max = 0, on = 0;
+        uint32_t toggles = 0, active = 0, histogram[ANALYZER_BUCKETS] = { 0 };
+        for (uint32_t f = 0; f < FIXTURE_FRAMES; f++) {
+            uint8_t v = frames[(size_t)f * FIXTURE_CHANNELS + ch];
+            if (v > max) max = v;
+            toggles += (v > 0) != on;
+            on = v > 0;
+            active += on;
+            histogram[v >> 6]++;
+        }
+        const ChannelStats& s = analysis.channels[ch];
+        TEST_ASSERT_EQUAL_UINT8(max, s.max);
+        TEST_ASSERT_EQUAL_UINT32(toggles, s.toggles);
+        TEST_ASSERT_EQUAL_UINT32(active, s.activeFrames);
+        TEST_ASSERT_EQUAL_MEMORY(histogram, s.histogram, sizeof(histogram));
+    }
+}
+
+static void test_report_lists_lit_channels(void) {
+    ChannelAnalysis analysis;
+    analysis.frames = 10;
+    analysis.stepTimeMs = 50;
+    analysis.channels.resize(4);
+    analysis.channels[2].max = 200;
+    analysis.channels[2].activeFrames = 3;
+    analysis.channels[2].toggles = 2;
+    analysis.channels[2].histogram[3] = 3;
+
+    MemorySink sink;
+    TEST_ASSERT_TRUE(writeChannelReport(analysis, "my \"show\".fseq", sink));
+    std::string json(sink.data.begin(), sink.data.end());
+    TEST_ASSERT_EQUAL_STRING("{\"show\":\"my show.fseq\",\"frames\":10,\"stepMs\":50,\"scanMs\":0,\"silent\":3,"
+                             "\"channels\":[{\"ch\":2,\"max\":200,\"active\":3,\"toggles\":2,\"hist\":[0,0,0,3]}]}",
+                             json.c_str());
+}
+
+int main(void) {
+    frames = makeFrames(FIXTURE_FRAMES, FIXTURE_CHANNELS);
+    v2z = buildV2(frames, FIXTURE_CHANNELS, FIXTURE_FRAMES, true, {});
+
+    UNITY_BEGIN();
+    RUN_TEST(test_stats_match_direct_count);
+    RUN_TEST(test_report_lists_lit_channels);
+    return UNITY_END();
+}
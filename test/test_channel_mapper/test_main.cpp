@@ -0,0 +1,184 @@
+/**
+ * ChannelMapper: the compiled map lights LEDs exactly like the legacy
+ * per-channel branches, color classes follow their formula and rule
+ * order, and the blend kernel stays within 1 of the exact mix.
+ */
+#include <unity.h>
+#include <math.h>
+#include "../ShowFixtures.h"
+#include "ChannelMapper.h"
+
+static uint8_t frame[LOGICAL_CHANNELS];
+
+void setUp(void) {
+    for (int i = 0; i < LOGICAL_CHANNELS; i++) frame[i] = (i * 37) & 0xFF;
+}
+
+void tearDown(void) {}
+
+/**
+ * The branchy mapping of the original firmware.
+ */
+static Rgb legacyColor(uint16_t rawCh, const uint8_t* fr) {
+    uint8_t val = (rawCh < 1024) ? fr[rawCh] : 0;
+    if (rawCh == 139 || rawCh == 142 || rawCh == 339 || rawCh == 342) return { val, (uint8_t)((val * 160) >> 8), 0 };
+    if ((rawCh >= 364 && rawCh <= 371) || rawCh == 392) return { val, 0, 0 };
+    if (rawCh >= 151 && rawCh <= 160) return { (uint8_t)((val * 100) >> 8), (uint8_t)((val * 100) >> 8), val };
+    return { val, val, val };
+}
+
+static void test_compiled_map_matches_legacy(void) {
+    const uint16_t n = 100;
+    std::vector<LedMapping> mapping(n);
+    for (uint16_t i = 0; i < n; i++) mapping[i].channel = sampleChannels[i % 25];
+    std::vector<uint16_t> src(n);
+    std::vector<uint8_t> color(n);
+    LedMapTable map = { src.data(), color.data(), defaultColorLuts(), n };
+    compileLedMap(mapping, map);
+
+    std::vector<Rgb> out(n);
+    for (int v = 0; v < 256; v++) {
+        for (uint16_t i = 0; i < n; i++) frame[mapping[i].channel] = (v + i) & 0xFF;
+        mapFrameToLeds(frame, map, out.data());
+        for (uint16_t i = 0; i < n; i++) {
+            Rgb expect = legacyColor(mapping[i].channel, frame);
+            TEST_ASSERT_EQUAL_UINT8(expect.r, out[i].r);
+            TEST_ASSERT_EQUAL_UINT8(expect.g, out[i].g);
+            TEST_ASSERT_EQUAL_UINT8(expect.b, out[i].b);
+        }
+    }
+}
+
+static void test_dead_leds_stay_dark(void) {
+    std::vector<LedMapping> mapping = { { 139 }, { 9999 } };
+    std::vector<uint16_t> src(2);
+    std::vector<uint8_t> color(2);
+    LedMapTable map = { src.data(), color.data(), defaultColorLuts(), 2 };
+    compileLedMap(mapping, map);
+    memset(frame, 255, sizeof(frame));
+
+    Rgb out[2];
+    mapFrameToLeds(frame, map, out);
+    TEST_ASSERT_EQUAL_UINT8(255, out[0].r);
+    TEST_ASSERT_EQUAL_UINT8(0, out[1].r);
+    TEST_ASSERT_EQUAL_UINT8(0, out[1].g);
+    TEST_ASSERT_EQUAL_UINT8(0, out[1].b);
+}
+
+/**
+ * A gamma/tint/limit class against the float formula.
+ */
+static void test_color_class_table(void) {
+    ColorClass warm;
+    snprintf(warm.name, sizeof(warm.name), "warm");
+    warm.tint[0] = 255; warm.tint[1] = 180; warm.tint[2] = 60;
+    warm.gamma = 2.2f;
+    warm.min[0] = 4;
+    warm.max[2] = 40;
+
+    ColorLut lut;
+    buildColorLut(warm, lut);
+    TEST_ASSERT_EQUAL_UINT8(0, lut.c[0][0]);   // Off stays off, min only applies to lit LEDs
+    TEST_ASSERT_EQUAL_UINT8(0, lut.c[1][0]);
+    for (int v = 1; v < 256; v++) {
+        double curved = round(255.0 * pow(v / 255.0, 2.2));
+        for (int c = 0; c < 3; c++) {
+            int exact = (int)(curved * (warm.tint[c] + 1)) >> 8;
+            exact = std::max(exact, (int)warm.min[c]);
+            exact = std::min(exact, (int)warm.max[c]);
+            TEST_ASSERT_EQUAL_UINT8(exact, lut.c[c][v]);
+        }
+        TEST_ASSERT_GREATER_OR_EQUAL(4, lut.c[0][v]);
+        TEST_ASSERT_LESS_OR_EQUAL(40, lut.c[2][v]);
+    }
+}
+
+/**
+ * LED rule over channel rule over the built-in class.
+ */
+static void test_color_rule_precedence(void) {
+    ColorProfile profile = defaultColorProfile();
+    ColorClass warm;
+    snprintf(warm.name, sizeof(warm.name), "warm");
+    profile.classes.push_back(warm);
+    uint8_t warmId = profile.classes.size() - 1;
+    TEST_ASSERT_EQUAL_INT(warmId, findColorClass(profile, "warm"));
+    TEST_ASSERT_EQUAL_INT(-1, findColorClass(profile, "nope"));
+
+    profile.rules.push_back({ warmId, false, 164, 165 });
+    profile.rules.push_back({ COLOR_BLUE, true, 2, 2 });
+    std::vector<LedMapping> mapping = { { 139 }, { 164 }, { 165 }, { 342 }, { 9999 } };
+    std::vector<uint16_t> src(5);
+    std::vector<uint8_t> color(5);
+    LedMapTable map = { src.data(), color.data(), nullptr, 5 };
+    compileLedMap(mapping, map, false, &profile);
+    TEST_ASSERT_EQUAL_UINT8(COLOR_AMBER, color[0]);
+    TEST_ASSERT_EQUAL_UINT8(warmId, color[1]);
+    TEST_ASSERT_EQUAL_UINT8(COLOR_BLUE, color[2]);
+    TEST_ASSERT_EQUAL_UINT8(COLOR_AMBER, color[3]);
+    TEST_ASSERT_EQUAL_UINT8(COLOR_OFF, color[4]);
+}
+
+/**
+ * Sidecar frames are in LED order: LED i reads byte i, the color still
+ * follows its channel.
+ */
+static void test_led_order_map(void) {
+    std::vector<LedMapping> mapping = { { 342 }, { 364 }, { 9999 } };
+    std::vector<uint16_t> src(3);
+    std::vector<uint8_t> color(3);
+    LedMapTable map = { src.data(), color.data(), defaultColorLuts(), 3 };
+    compileLedMap(mapping, map, true);
+    TEST_ASSERT_EQUAL_UINT16(0, src[0]);
+    TEST_ASSERT_EQUAL_UINT16(1, src[1]);
+    TEST_ASSERT_EQUAL_UINT8(COLOR_AMBER, color[0]);
+    TEST_ASSERT_EQUAL_UINT8(channelColorClass(364), color[1]);
+    TEST_ASSERT_EQUAL_UINT8(COLOR_OFF, color[2]);
+}
+
+/**
+ * Weight 0 and 256 are the frames themselves, in between within 1.
+ */
+static void test_blend_ends_and_middle(void) {
+    const uint16_t n = 100;
+    static uint8_t from[LOGICAL_CHANNELS], to[LOGICAL_CHANNELS];
+    for (int i = 0; i < LOGICAL_CHANNELS; i++) {
+        from[i] = (i * 37) & 0xFF;
+        to[i] = (i * 91 + 13) & 0xFF;
+    }
+    std::vector<LedMapping> mapping(n);
+    for (uint16_t i = 0; i < n; i++) mapping[i].channel = sampleChannels[i % 25];
+    std::vector<uint16_t> src(n);
+    std::vector<uint8_t> color(n);
+    LedMapTable map = { src.data(), color.data(), defaultColorLuts(), n };
+    compileLedMap(mapping, map);
+    ColorProfile builtin = defaultColorProfile();
+
+    std::vector<Rgb> plain(n), blended(n);
+    mapFrameToLeds(from, map, plain.data());
+    blendFrameToLeds(from, to, 0, map, blended.data());
+    TEST_ASSERT_EQUAL_MEMORY(plain.data(), blended.data(), n * sizeof(Rgb));
+    mapFrameToLeds(to, map, plain.data());
+    blendFrameToLeds(from, to, 256, map, blended.data());
+    TEST_ASSERT_EQUAL_MEMORY(plain.data(), blended.data(), n * sizeof(Rgb));
+
+    for (uint16_t w = 0; w <= 256; w += 16) {
+        blendFrameToLeds(from, to, w, map, blended.data());
+        for (uint16_t i = 0; i < n; i++) {
+            double val = (from[src[i]] * (256 - w) + to[src[i]] * w) / 256.0;
+            int exact = (int)((val * (builtin.classes[color[i]].tint[0] + 1)) / 256.0);
+            TEST_ASSERT_INT_WITHIN(1, exact, blended[i].r);
+        }
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_compiled_map_matches_legacy);
+    RUN_TEST(test_dead_leds_stay_dark);
+    RUN_TEST(test_color_class_table);
+    RUN_TEST(test_color_rule_precedence);
+    RUN_TEST(test_led_order_map);
+    RUN_TEST(test_blend_ends_and_middle);
+    return UNITY_END();
+}
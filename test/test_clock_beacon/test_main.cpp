@@ -0,0 +1,72 @@
+/**
+ * ClockBeacon: beacons round trip, other packets are dropped, and the
+ * follower slews small errors, ignores delay and jumps on large ones.
+ */
+#include <unity.h>
+#include "ClockBeacon.h"
+
+static ClockFollower follower;
+
+void setUp(void) {
+    follower.reset();
+}
+
+void tearDown(void) {}
+
+static ClockBeacon beaconAt(int64_t showTimeUs) {
+    ClockBeacon b;
+    b.showId = 7;
+    b.showTimeUs = showTimeUs;
+    b.stepTimeMs = 20;
+    return b;
+}
+
+static void test_beacon_round_trip(void) {
+    ClockBeacon b = beaconAt(123456789012LL), back;
+    b.frame = 4242;
+    b.sequence = 65535;
+    uint8_t raw[BEACON_SIZE];
+    encodeBeacon(b, raw);
+    TEST_ASSERT_TRUE(decodeBeacon(raw, sizeof(raw), back));
+    TEST_ASSERT_EQUAL_UINT32(b.showId, back.showId);
+    TEST_ASSERT_EQUAL_UINT32(b.frame, back.frame);
+    TEST_ASSERT_EQUAL_INT64(b.showTimeUs, back.showTimeUs);
+    TEST_ASSERT_EQUAL_UINT16(b.stepTimeMs, back.stepTimeMs);
+    TEST_ASSERT_EQUAL_UINT16(b.sequence, back.sequence);
+
+    TEST_ASSERT_FALSE(decodeBeacon(raw, BEACON_SIZE - 1, back));
+    raw[0] = 'X';
+    TEST_ASSERT_FALSE(decodeBeacon(raw, sizeof(raw), back));
+}
+
+static void test_small_error_is_slewed(void) {
+    TEST_ASSERT_EQUAL_INT64(3000, follower.onBeacon(beaconAt(1000000), 1003000));
+    follower.reset();
+    TEST_ASSERT_EQUAL_INT64(FOLLOWER_MAX_SLEW_US, follower.onBeacon(beaconAt(1000000), 1020000));
+    TEST_ASSERT_EQUAL_INT64(FOLLOWER_MAX_SLEW_US, follower.onBeacon(beaconAt(1250000), 1270000 - FOLLOWER_MAX_SLEW_US));
+    TEST_ASSERT_EQUAL_UINT32(0, follower.jumps());
+}
+
+/**
+ * The minimum filter: a delayed beacon does not pull the clock back.
+ */
+static void test_delay_is_filtered(void) {
+    TEST_ASSERT_EQUAL_INT64(0, follower.onBeacon(beaconAt(1000000), 1000000));
+    TEST_ASSERT_EQUAL_INT64(0, follower.onBeacon(beaconAt(1250000), 1250000 + 40000));
+    TEST_ASSERT_EQUAL_INT64(0, follower.phaseErrorUs());
+}
+
+static void test_large_error_jumps(void) {
+    TEST_ASSERT_EQUAL_INT64(-2000000, follower.onBeacon(beaconAt(5000000), 3000000));
+    TEST_ASSERT_EQUAL_UINT32(1, follower.jumps());
+    TEST_ASSERT_EQUAL_UINT32(1, follower.beacons());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_beacon_round_trip);
+    RUN_TEST(test_small_error_is_slewed);
+    RUN_TEST(test_delay_is_filtered);
+    RUN_TEST(test_large_error_jumps);
+    return UNITY_END();
+}
@@ -0,0 +1,136 @@
+/**
+ * DeltaCodec (.lsq): records round trip, whole shows convert losslessly
+ * and seek through the keyframe index, corrupt data is rejected.
+ */
+#include <unity.h>
+#include "../ShowFixtures.h"
+#include "DeltaCodec.h"
+#include "FseqReader.h"
+
+static std::vector<uint8_t> frames, sparseExpect;
+static std::vector<uint8_t> v1, v2s;
+static uint8_t logical[LOGICAL_CHANNELS];
+
+void setUp(void) {
+    memset(logical, 0, sizeof(logical));
+}
+
+void tearDown(void) {}
+
+static void test_record_round_trip(void) {
+    uint8_t prev[64], cur[64], out[2 * 64 + 8], check[64];
+    for (int i = 0; i < 64; i++) {
+        prev[i] = i;
+        cur[i] = i < 10 ? i : (i < 40 ? 0xAA : i * 3);   // Unchanged, fill and literal runs
+    }
+    size_t len = encodeDeltaRecord(prev, cur, 64, out);
+    memcpy(check, prev, 64);
+    TEST_ASSERT_TRUE(applyDeltaRecord(check, 64, out, len));
+    TEST_ASSERT_EQUAL_MEMORY(cur, check, 64);
+
+    // Unchanged frame: empty record
+    TEST_ASSERT_EQUAL_size_t(0, encodeDeltaRecord(cur, cur, 64, out));
+}
+
+static void test_corrupt_record_is_rejected(void) {
+    uint8_t frame[16] = { 0 };
+    const uint8_t overrun[] = { 0x0F, 0xC0, 1 };      // Skip 16, then fill past the end
+    const uint8_t shortLiteral[] = { 0x83, 1, 2 };    // 4 literal bytes announced, 2 given
+    const uint8_t noFillValue[] = { 0xC3 };
+    TEST_ASSERT_FALSE(applyDeltaRecord(frame, 16, overrun, sizeof(overrun)));
+    TEST_ASSERT_FALSE(applyDeltaRecord(frame, 16, shortLiteral, sizeof(shortLiteral)));
+    TEST_ASSERT_FALSE(applyDeltaRecord(frame, 16, noFillValue, sizeof(noFillValue)));
+}
+
+static void convertsLosslessly(const std::vector<uint8_t>& file, const std::vector<uint8_t>& expect,
+                               MemorySink& sink) {
+    MemorySource src(file.data(), file.size());
+    FseqReader reader;
+    TEST_ASSERT_TRUE(reader.open(&src));
+    DeltaStats stats;
+    TEST_ASSERT_TRUE_MESSAGE(encodeDeltaShow(reader, sink, stats), reader.lastError());
+    TEST_ASSERT_EQUAL_UINT32(FIXTURE_FRAMES, stats.frames);
+    TEST_ASSERT_EQUAL_UINT32(sink.data.size(), stats.bytesOut);
+    TEST_ASSERT_LESS_THAN(file.size() / 4, stats.bytesOut);
+
+    MemorySource lsq(sink.data.data(), sink.data.size());
+    FseqReader delta;
+    TEST_ASSERT_TRUE_MESSAGE(delta.open(&lsq), delta.lastError());
+    TEST_ASSERT_EQUAL_UINT8(SHOW_CODEC_DELTA, delta.info().compression);
+    TEST_ASSERT_EQUAL_UINT32(FIXTURE_FRAMES, delta.info().frameCount);
+    TEST_ASSERT_EQUAL_UINT32(FIXTURE_STEP_MS, delta.info().stepTimeMs);
+    for (uint32_t f = 0; f < FIXTURE_FRAMES; f++) {
+        TEST_ASSERT_TRUE(delta.readFrame(f, logical));
+        TEST_ASSERT_EQUAL_MEMORY(expect.data() + (size_t)f * FIXTURE_CHANNELS, logical, reader.info().channelCount);
+    }
+}
+
+static void test_v1_converts_losslessly(void) {
+    MemorySink sink;
+    convertsLosslessly(v1, frames, sink);
+}
+
+static void test_sparse_converts_losslessly(void) {
+    MemorySink sink;
+    convertsLosslessly(v2s, sparseExpect, sink);
+}
+
+/**
+ * Late join on an .lsq: a fresh reader seeks through the keyframe index
+ * to mid-show frames, also right before and on a keyframe.
+ */
+static void test_seek_through_keyframes(void) {
+    MemorySink sink;
+    convertsLosslessly(v1, frames, sink);
+    const uint32_t starts[] = { 1, DELTA_KEY_INTERVAL - 1, DELTA_KEY_INTERVAL, 1001, FIXTURE_FRAMES - 8 };
+    for (uint32_t first : starts) {
+        MemorySource lsq(sink.data.data(), sink.data.size());
+        FseqReader reader;
+        TEST_ASSERT_TRUE(reader.open(&lsq));
+        for (uint32_t f = first; f < first + 8; f++) {
+            TEST_ASSERT_TRUE(reader.readFrame(f, logical));
+            TEST_ASSERT_EQUAL_MEMORY(frames.data() + (size_t)f * FIXTURE_CHANNELS, logical, FIXTURE_CHANNELS);
+        }
+    }
+}
+
+/**
+ * A cut index or a forged key count must be rejected before the index
+ * is allocated.
+ */
+static void test_corrupt_header_is_rejected(void) {
+    MemorySink sink;
+    convertsLosslessly(v1, frames, sink);
+
+    std::vector<uint8_t> cut(sink.data.begin(), sink.data.end() - 4), forged(sink.data);
+    uint32_t keyInterval = forged[14] | (forged[15] << 8);
+    putLe32(forged, 8, 0xFFFFFFF0u);
+    putLe32(forged, 20, (0xFFFFFFF0ull + keyInterval - 1) / keyInterval);
+
+    MemorySource cutSrc(cut.data(), cut.size()), forgedSrc(forged.data(), forged.size());
+    FseqReader reader;
+    TEST_ASSERT_FALSE(reader.open(&cutSrc));
+    TEST_ASSERT_EQUAL_STRING("Truncated .lsq keyframe index.", reader.lastError());
+    TEST_ASSERT_FALSE(reader.open(&forgedSrc));
+
+    std::vector<uint8_t> wrongCount(sink.data);
+    putLe32(wrongCount, 20, 1);
+    MemorySource wrongSrc(wrongCount.data(), wrongCount.size());
+    TEST_ASSERT_FALSE(reader.open(&wrongSrc));
+    TEST_ASSERT_EQUAL_STRING("Corrupt .lsq show header.", reader.lastError());
+}
+
+int main(void) {
+    frames = makeFrames(FIXTURE_FRAMES, FIXTURE_CHANNELS);
+    v1 = buildV1(frames, FIXTURE_CHANNELS, FIXTURE_FRAMES);
+    v2s = buildSparse(frames, FIXTURE_FRAMES, sparseExpect);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_record_round_trip);
+    RUN_TEST(test_corrupt_record_is_rejected);
+    RUN_TEST(test_v1_converts_losslessly);
+    RUN_TEST(test_sparse_converts_losslessly);
+    RUN_TEST(test_seek_through_keyframes);
+    RUN_TEST(test_corrupt_header_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,110 @@
+/**
+ * FileIndex: file kinds by name, show details from the reader, sorted
+ * records, and a save/load round trip that rejects damaged data.
+ */
+#include <unity.h>
+#include "../ShowFixtures.h"
+#include "FileIndex.h"
+
+static FileIndex files;
+
+void setUp(void) {
+    files.clear();
+}
+
+void tearDown(void) {}
+
+static FileRecord record(const char* name, uint32_t size) {
+    FileRecord rec;
+    snprintf(rec.name, sizeof(rec.name), "%s", name);
+    rec.size = size;
+    rec.kind = fileKindOf(name);
+    return rec;
+}
+
+static void test_kinds_by_name(void) {
+    TEST_ASSERT_EQUAL_UINT8(FILE_KIND_SHOW, fileKindOf("/show.fseq"));
+    TEST_ASSERT_EQUAL_UINT8(FILE_KIND_SHOW, fileKindOf("show.lsq"));
+    TEST_ASSERT_EQUAL_UINT8(FILE_KIND_CONFIG, fileKindOf("/config_all_25.json"));
+    TEST_ASSERT_EQUAL_UINT8(FILE_KIND_OTHER, fileKindOf("/other.json"));
+    TEST_ASSERT_EQUAL_UINT8(FILE_KIND_SIDECAR, fileKindOf("1234abcd5678ef90.lsc"));
+    TEST_ASSERT_EQUAL_UINT8(FILE_KIND_SIDECAR, fileKindOf("1234abcd5678ef90.lsp"));
+    TEST_ASSERT_EQUAL_UINT8(FILE_KIND_REPORT, fileKindOf("1234abcd.lsa"));
+    TEST_ASSERT_EQUAL_UINT8(FILE_KIND_OTHER, fileKindOf("/index.html.gz"));
+}
+
+static void test_describe_show(void) {
+    std::vector<uint8_t> frames = makeFrames(100, 64);
+    std::vector<uint8_t> v1 = buildV1(frames, 64, 100);
+    MemorySource src(v1.data(), v1.size());
+    FseqReader reader;
+    TEST_ASSERT_TRUE(reader.open(&src));
+
+    FileRecord rec = record("show.fseq", v1.size());
+    describeShow(rec, reader.info());
+    TEST_ASSERT_EQUAL_UINT8(1, rec.version);
+    TEST_ASSERT_EQUAL_UINT32(100, rec.frames);
+    TEST_ASSERT_EQUAL_UINT32(64, rec.channels);
+    TEST_ASSERT_EQUAL_UINT16(FIXTURE_STEP_MS, rec.stepTimeMs);
+    TEST_ASSERT_EQUAL_UINT32(100 * FIXTURE_STEP_MS, rec.durationMs());
+}
+
+static void test_put_find_remove(void) {
+    files.put(record("b.fseq", 2));
+    files.put(record("a.fseq", 1));
+    files.put(record("b.fseq", 3));   // Replaces
+    TEST_ASSERT_EQUAL_size_t(2, files.records().size());
+    TEST_ASSERT_EQUAL_STRING("a.fseq", files.records()[0].name);
+    TEST_ASSERT_EQUAL_UINT32(3, files.find("/b.fseq")->size);   // Leading slash is ignored
+    TEST_ASSERT_TRUE(files.remove("a.fseq"));
+    TEST_ASSERT_FALSE(files.remove("a.fseq"));
+    TEST_ASSERT_NULL(files.find("a.fseq"));
+}
+
+static void test_save_load_round_trip(void) {
+    for (int i = 0; i < 36; i++) {
+        char name[FILE_INDEX_NAME];
+        snprintf(name, sizeof(name), i % 2 ? "show_%02d.fseq" : "config_%02d.json", i);
+        FileRecord rec = record(name, 1000 + i);
+        rec.frames = i * 10;
+        rec.stepTimeMs = 20;
+        rec.channels = 512;
+        rec.leds = i;
+        snprintf(rec.label, sizeof(rec.label), "RC_S3XY_Compact_%d", i);
+        files.put(rec);
+    }
+    MemorySink sink;
+    TEST_ASSERT_TRUE(files.save(sink));
+    TEST_ASSERT_EQUAL_size_t(FILE_INDEX_HEADER + 36 * FILE_INDEX_RECORD, sink.data.size());
+
+    FileIndex loaded;
+    MemorySource src(sink.data.data(), sink.data.size());
+    TEST_ASSERT_TRUE(loaded.load(src));
+    TEST_ASSERT_EQUAL_size_t(36, loaded.records().size());
+    for (size_t i = 0; i < 36; i++) {
+        const FileRecord& a = files.records()[i];
+        const FileRecord& b = loaded.records()[i];
+        TEST_ASSERT_EQUAL_STRING(a.name, b.name);
+        TEST_ASSERT_EQUAL_UINT32(a.size, b.size);
+        TEST_ASSERT_EQUAL_UINT8(a.kind, b.kind);
+        TEST_ASSERT_EQUAL_UINT32(a.frames, b.frames);
+        TEST_ASSERT_EQUAL_UINT16(a.stepTimeMs, b.stepTimeMs);
+        TEST_ASSERT_EQUAL_UINT32(a.channels, b.channels);
+        TEST_ASSERT_EQUAL_UINT16(a.leds, b.leds);
+        TEST_ASSERT_EQUAL_STRING(a.label, b.label);
+    }
+
+    // A cut file is not an index
+    MemorySource cut(sink.data.data(), sink.data.size() - 1);
+    TEST_ASSERT_FALSE(loaded.load(cut));
+    TEST_ASSERT_EQUAL_size_t(0, loaded.records().size());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_kinds_by_name);
+    RUN_TEST(test_describe_show);
+    RUN_TEST(test_put_find_remove);
+    RUN_TEST(test_save_load_round_trip);
+    return UNITY_END();
+}
@@ -0,0 +1,79 @@
+/**
+ * FrameClock: absolute deadlines keep an hour-long show on its ideal
+ * frame through an irregular loop and a stall; lag compensation skips
+ * exactly the frames that were missed.
+ */
+#include <unity.h>
+#include <stdlib.h>
+#include "FrameClock.h"
+
+#define STEP_MS 20
+
+static FrameClock frameClock;
+
+void setUp(void) {
+    frameClock.reset();
+    frameClock.start(0, STEP_MS);
+}
+
+void tearDown(void) {}
+
+static void test_releases_on_deadline(void) {
+    TEST_ASSERT_TRUE(frameClock.poll(0));
+    frameClock.advance();
+    TEST_ASSERT_FALSE(frameClock.poll(STEP_MS * 1000 - 1));
+    TEST_ASSERT_EQUAL_INT64(1, frameClock.untilDue(STEP_MS * 1000 - 1));
+    TEST_ASSERT_TRUE(frameClock.poll(STEP_MS * 1000 + 300));
+    TEST_ASSERT_EQUAL_UINT32(1, frameClock.current());
+    TEST_ASSERT_EQUAL_UINT32(300, frameClock.maxLateUs());
+    TEST_ASSERT_EQUAL_UINT32(1, frameClock.lateness()[1]);   // 250-500 us
+}
+
+/**
+ * Frame 500 of a show that started at 1 s is due at 11 s.
+ */
+static void test_late_join_starts_mid_show(void) {
+    const uint64_t dueUs = 1000000 + 500ULL * STEP_MS * 1000;
+    frameClock.start(1000000, STEP_MS, 500);
+    TEST_ASSERT_EQUAL_UINT32(500, frameClock.current());
+    TEST_ASSERT_FALSE(frameClock.poll(dueUs - 1));
+    TEST_ASSERT_TRUE(frameClock.poll(dueUs));
+    TEST_ASSERT_EQUAL_UINT32(0, frameClock.skipped());
+}
+
+/**
+ * Small lags are played through, larger ones jump to the due frame.
+ */
+static void test_lag_compensation(void) {
+    TEST_ASSERT_TRUE(frameClock.poll((FRAME_CLOCK_MAX_LAG) * STEP_MS * 1000));
+    TEST_ASSERT_EQUAL_UINT32(0, frameClock.current());
+    frameClock.advance();
+    TEST_ASSERT_TRUE(frameClock.poll(10 * STEP_MS * 1000 + 5));
+    TEST_ASSERT_EQUAL_UINT32(10, frameClock.current());
+    TEST_ASSERT_EQUAL_UINT32(9, frameClock.skipped());
+}
+
+/**
+ * One hour, loop period 0-3 ms, one 200 ms stall: ends on the ideal
+ * frame with exactly the stalled frames skipped.
+ */
+static void test_hour_without_drift(void) {
+    const uint64_t showUs = 3600ULL * 1000000ULL;
+    srand(7);
+    for (uint64_t now = 0; now < showUs; now += 1 + (rand() % 3000)) {
+        if (now >= 5000000 && now < 5200000) continue;
+        if (frameClock.poll(now)) frameClock.advance();
+    }
+    TEST_ASSERT_EQUAL_UINT32(showUs / (STEP_MS * 1000), frameClock.current());
+    TEST_ASSERT_EQUAL_UINT32(10, frameClock.skipped());
+    TEST_ASSERT_LESS_THAN(3000, frameClock.avgLateUs());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_releases_on_deadline);
+    RUN_TEST(test_late_join_starts_mid_show);
+    RUN_TEST(test_lag_compensation);
+    RUN_TEST(test_hour_without_drift);
+    return UNITY_END();
+}
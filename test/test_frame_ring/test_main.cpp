@@ -0,0 +1,185 @@
+/**
+ * FrameRing: the reader/render handshake of the firmware, stepped by
+ * hand across a playlist show switch. The reader being one show ahead
+ * must not starve the next show, the render path being ahead must end
+ * the reader's show, and a sparse next show must not inherit channels.
+ */
+#include <unity.h>
+#include <string.h>
+#include "FrameRing.h"
+
+#define DEPTH 8
+
+/**
+ * Synthetic show: channels [0, channels) of frame f hold value + f.
+ */
+struct Show {
+  uint32_t frames;
+  uint16_t channels;
+  uint8_t value;
+};
+
+static const Show showA = { 100, 512, 0x40 };
+static const Show showB = { 50, 100, 0x80 };   // Sparse: covers fewer channels than A
+
+static FrameSlot ring[DEPTH];
+static uint32_t head, tail, wanted;
+static uint8_t readerSeg, renderSeg;
+static const Show* readerShow;
+static const Show* readerNext;
+static uint32_t nextFrame;
+
+void setUp(void) {
+    memset(ring, 0, sizeof(ring));   // As startFramePrefetch()
+    head = tail = wanted = 0;
+    readerSeg = renderSeg = 0;
+    readerShow = &showA;
+    readerNext = &showB;
+    nextFrame = 0;
+}
+
+void tearDown(void) {}
+
+/**
+ * One pass of frameReaderTask(); false when it would sleep.
+ */
+static bool readerStep(void) {
+    nextFrame = readerNextFrame(readerSeg, renderSeg, nextFrame, wanted, readerShow->frames);
+    if (nextFrame >= readerShow->frames && readerNext) {
+        readerShow = readerNext;
+        readerNext = nullptr;
+        readerSeg++;
+        nextFrame = readerNextFrame(readerSeg, renderSeg, 0, wanted, readerShow->frames);
+    }
+    if (head - tail >= DEPTH || nextFrame >= readerShow->frames) return false;
+
+    FrameSlot& slot = ring[head % DEPTH];
+    claimSlot(slot, readerSeg);
+    for (uint16_t ch = 0; ch < readerShow->channels; ch++) slot.data[ch] = readerShow->value + nextFrame;
+    slot.frameIdx = nextFrame++;
+    head++;
+    return true;
+}
+
+static void fillRing(void) {
+    while (readerStep()) {}
+}
+
+/**
+ * playFrame(): the slot of 'frameIdx'. An empty ring wakes the reader;
+ * null when it has nothing to give (a stall) or the frame is missing.
+ */
+static const FrameSlot* renderTake(uint32_t frameIdx) {
+    wanted = frameIdx;
+    for (;;) {
+        if (head == tail && !readerStep()) return nullptr;
+        const FrameSlot& candidate = ring[tail % DEPTH];
+        SlotAction action = judgeSlot(candidate, renderSeg, frameIdx);
+        if (action == SLOT_MISSING) return nullptr;
+        if (action == SLOT_PLAY) return &candidate;
+        tail++;
+    }
+}
+
+/**
+ * switchToNextShow()
+ */
+static void renderSwitch(void) {
+    wanted = 0;
+    renderSeg++;
+}
+
+static void playsFrame(const Show& show, uint32_t frameIdx) {
+    fillRing();
+    const FrameSlot* slot = renderTake(frameIdx);
+    TEST_ASSERT_NOT_NULL_MESSAGE(slot, "reader stall");
+    TEST_ASSERT_EQUAL_UINT32(frameIdx, slot->frameIdx);
+    for (uint16_t ch = 0; ch < 512; ch++) {
+        TEST_ASSERT_EQUAL_UINT8(ch < show.channels ? (uint8_t)(show.value + frameIdx) : 0, slot->data[ch]);
+    }
+    tail++;
+}
+
+static void test_segments_wrap(void) {
+    TEST_ASSERT_EQUAL_INT(1, segmentsAhead(0, 255));
+    TEST_ASSERT_EQUAL_INT(-1, segmentsAhead(255, 0));
+    TEST_ASSERT_EQUAL_INT(0, segmentsAhead(7, 7));
+}
+
+static void test_reader_decisions(void) {
+    TEST_ASSERT_EQUAL_UINT32(20, readerNextFrame(3, 3, 10, 20, 100));    // Lag compensation
+    TEST_ASSERT_EQUAL_UINT32(10, readerNextFrame(3, 3, 10, 5, 100));
+    TEST_ASSERT_EQUAL_UINT32(10, readerNextFrame(4, 3, 10, 90, 100));    // Ahead: the wanted frame is the old show's
+    TEST_ASSERT_EQUAL_UINT32(100, readerNextFrame(3, 4, 10, 0, 100));    // Render path left the show
+    TEST_ASSERT_EQUAL_UINT32(10, readerNextFrame(0, 255, 10, 0, 100));   // Ahead across the wrap
+}
+
+static void test_slot_decisions(void) {
+    FrameSlot slot;
+    slot.segment = 2;
+    slot.frameIdx = 10;
+    TEST_ASSERT_EQUAL_UINT8(SLOT_PLAY, judgeSlot(slot, 2, 10));
+    TEST_ASSERT_EQUAL_UINT8(SLOT_PLAY, judgeSlot(slot, 2, 9));
+    TEST_ASSERT_EQUAL_UINT8(SLOT_DROP, judgeSlot(slot, 2, 11));
+    TEST_ASSERT_EQUAL_UINT8(SLOT_DROP, judgeSlot(slot, 3, 0));
+    TEST_ASSERT_EQUAL_UINT8(SLOT_MISSING, judgeSlot(slot, 1, 0));
+}
+
+static void test_claim_clears_other_show(void) {
+    FrameSlot slot;
+    memset(&slot, 0x77, sizeof(slot));
+    slot.segment = 4;
+    claimSlot(slot, 4);
+    TEST_ASSERT_EQUAL_UINT8(0x77, slot.data[LOGICAL_CHANNELS - 1]);
+    claimSlot(slot, 5);
+    TEST_ASSERT_EQUAL_UINT8(5, slot.segment);
+    TEST_ASSERT_EQUAL_UINT8(0, slot.data[0]);
+    TEST_ASSERT_EQUAL_UINT8(0, slot.data[LOGICAL_CHANNELS - 1]);
+}
+
+/**
+ * The normal gapless switch: the reader reads into the next show while
+ * the last frames of the current one are still queued.
+ */
+static void test_switch_with_reader_ahead(void) {
+    bool readerWasAhead = false;
+    for (uint32_t f = 0; f < showA.frames; f++) {
+        playsFrame(showA, f);
+        readerWasAhead = readerWasAhead || segmentsAhead(readerSeg, renderSeg) > 0;
+    }
+    TEST_ASSERT_TRUE(readerWasAhead);
+    renderSwitch();
+    for (uint32_t f = 0; f < showB.frames; f++) playsFrame(showB, f);
+    TEST_ASSERT_FALSE(readerStep());
+}
+
+/**
+ * Render path running late: it switched before the reader got to the end
+ * of the current show. The reader drops that show and starts the next.
+ */
+static void test_switch_with_render_ahead(void) {
+    playsFrame(showA, 0);
+    renderSwitch();
+    for (uint32_t f = 0; f < showB.frames; f++) playsFrame(showB, f);
+}
+
+/**
+ * Lag compensation within a show skips the frames in between.
+ */
+static void test_render_jump_skips_frames(void) {
+    playsFrame(showA, 0);
+    playsFrame(showA, 40);
+    playsFrame(showA, 41);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_segments_wrap);
+    RUN_TEST(test_reader_decisions);
+    RUN_TEST(test_slot_decisions);
+    RUN_TEST(test_claim_clears_other_show);
+    RUN_TEST(test_switch_with_reader_ahead);
+    RUN_TEST(test_switch_with_render_ahead);
+    RUN_TEST(test_render_jump_skips_frames);
+    return UNITY_END();
+}
@@ -0,0 +1,214 @@
+/**
+ * FseqReader: every format decodes to the same logical frames, in order,
+ * after a seek and through range reads; bad headers are turned away.
+ */
+#include <unity.h>
+#include "../ShowFixtures.h"
+#include "FseqReader.h"
+
+static std::vector<uint8_t> frames, sparseExpect;
+static std::vector<uint8_t> v1, v2z, v2s;
+static uint8_t logical[LOGICAL_CHANNELS];
+
+void setUp(void) {
+    memset(logical, 0, sizeof(logical));   // Like the ring: unmapped channels stay black
+}
+
+void tearDown(void) {}
+
+static void readsEveryFrame(const std::vector<uint8_t>& file, const std::vector<uint8_t>& expect) {
+    MemorySource src(file.data(), file.size());
+    FseqReader reader;
+    TEST_ASSERT_TRUE_MESSAGE(reader.open(&src), reader.lastError());
+    TEST_ASSERT_EQUAL_UINT32(FIXTURE_FRAMES, reader.info().frameCount);
+    TEST_ASSERT_EQUAL_UINT32(FIXTURE_STEP_MS, reader.info().stepTimeMs);
+    for (uint32_t f = 0; f < FIXTURE_FRAMES; f++) {
+        TEST_ASSERT_TRUE_MESSAGE(reader.readFrame(f, logical), reader.lastError());
+        TEST_ASSERT_EQUAL_MEMORY(expect.data() + (size_t)f * FIXTURE_CHANNELS, logical, FIXTURE_CHANNELS);
+    }
+}
+
+static void test_v1_decodes_every_frame(void) {
+    readsEveryFrame(v1, frames);
+}
+
+static void test_v2_zlib_decodes_every_frame(void) {
+    readsEveryFrame(v2z, frames);
+}
+
+static void test_v2_sparse_places_ranges_at_their_channels(void) {
+    readsEveryFrame(v2s, sparseExpect);
+}
+
+static void test_v2_header_fields(void) {
+    MemorySource src(v2z.data(), v2z.size());
+    FseqReader reader;
+    TEST_ASSERT_TRUE(reader.open(&src));
+    TEST_ASSERT_EQUAL_UINT8(FSEQ_COMPRESSION_ZLIB, reader.info().compression);
+    TEST_ASSERT_EQUAL_UINT32((FIXTURE_FRAMES + FIXTURE_BLOCK - 1) / FIXTURE_BLOCK, reader.info().blockCount);
+    TEST_ASSERT_EQUAL_STRING("show.mp3", reader.info().mediaFile.c_str());
+}
+
+/**
+ * Out-of-order frames from the end of every zlib block (worst-case seek).
+ */
+static void test_zlib_random_seek(void) {
+    MemorySource src(v2z.data(), v2z.size());
+    FseqReader reader;
+    TEST_ASSERT_TRUE(reader.open(&src));
+    for (uint32_t i = 0; i < 64; i++) {
+        uint32_t f = (uint32_t)(((uint64_t)i * 7919 * FIXTURE_BLOCK) % FIXTURE_FRAMES) | (FIXTURE_BLOCK - 1);
+        if (f >= FIXTURE_FRAMES) continue;
+        TEST_ASSERT_TRUE(reader.readFrame(f, logical));
+        TEST_ASSERT_EQUAL_MEMORY(frames.data() + (size_t)f * FIXTURE_CHANNELS, logical, FIXTURE_CHANNELS);
+    }
+}
+
+/**
+ * Late join: a fresh reader seeks to a mid-show frame and reads the ring
+ * prefill from there.
+ */
+static void test_late_join_prefill(void) {
+    const std::vector<uint8_t>* files[] = { &v1, &v2z, &v2s };
+    const std::vector<uint8_t>* expects[] = { &frames, &frames, &sparseExpect };
+    for (int i = 0; i < 3; i++) {
+        MemorySource src(files[i]->data(), files[i]->size());
+        FseqReader reader;
+        TEST_ASSERT_TRUE(reader.open(&src));
+        for (uint32_t f = 1001; f < 1009; f++) {
+            TEST_ASSERT_TRUE(reader.readFrame(f, logical));
+            TEST_ASSERT_EQUAL_MEMORY(expects[i]->data() + (size_t)f * FIXTURE_CHANNELS, logical, FIXTURE_CHANNELS);
+        }
+    }
+}
+
+static void test_frame_out_of_range_fails(void) {
+    MemorySource src(v1.data(), v1.size());
+    FseqReader reader;
+    TEST_ASSERT_TRUE(reader.open(&src));
+    TEST_ASSERT_FALSE(reader.readFrame(FIXTURE_FRAMES, logical));
+}
+
+static void test_coalesce_bridges_small_gaps(void) {
+    std::vector<ChannelRange> r = coalesceChannels({ 10, 12, 11, 100, 9999, 12 }, 2);
+    TEST_ASSERT_EQUAL_size_t(2, r.size());
+    TEST_ASSERT_EQUAL_UINT16(10, r[0].start);
+    TEST_ASSERT_EQUAL_UINT16(3, r[0].count);
+    TEST_ASSERT_EQUAL_UINT16(100, r[1].start);
+    TEST_ASSERT_EQUAL_UINT16(1, r[1].count);
+    TEST_ASSERT_EQUAL_size_t(1, coalesceChannels({ 10, 12, 100 }, 100).size());
+}
+
+/**
+ * Range reads of the sample config's channels: fewer bytes per frame,
+ * same values on every mapped channel, dense and sparse.
+ */
+static void test_range_reads_keep_mapped_channels(void) {
+    std::vector<uint16_t> used(sampleChannels, sampleChannels + 25);
+    const std::vector<uint8_t>* files[] = { &v1, &v2s };
+    const std::vector<uint8_t>* expects[] = { &frames, &sparseExpect };
+    const uint16_t gaps[] = { 0, 16, FSEQ_READ_GAP };
+    for (int i = 0; i < 2; i++) {
+        for (uint16_t gap : gaps) {
+            MemorySource src(files[i]->data(), files[i]->size());
+            FseqReader reader;
+            TEST_ASSERT_TRUE(reader.open(&src));
+            std::vector<ChannelRange> ranges = coalesceChannels(used, gap);
+            reader.setReadRanges(ranges);
+            TEST_ASSERT_LESS_THAN(reader.info().stride, reader.bytesPerFrame());
+            TEST_ASSERT_EQUAL_UINT16(ranges.size(), reader.readsPerFrame());
+            for (uint32_t f = 0; f < FIXTURE_FRAMES; f += 7) {
+                TEST_ASSERT_TRUE(reader.readFrame(f, logical));
+                for (uint16_t ch : used) {
+                    TEST_ASSERT_EQUAL_UINT8((*expects[i])[(size_t)f * FIXTURE_CHANNELS + ch], logical[ch]);
+                }
+            }
+        }
+    }
+}
+
+static void test_direct_frame_only_for_raw_mapped_data(void) {
+    MemorySource dense(v1.data(), v1.size()), zlib(v2z.data(), v2z.size());
+    FseqReader a, b;
+    TEST_ASSERT_TRUE(a.open(&dense));
+    TEST_ASSERT_TRUE(b.open(&zlib));
+    const uint8_t* frame = a.directFrame(1234);
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ASSERT_EQUAL_MEMORY(frames.data() + (size_t)1234 * FIXTURE_CHANNELS, frame, FIXTURE_CHANNELS);
+    TEST_ASSERT_NULL(a.directFrame(FIXTURE_FRAMES));
+    TEST_ASSERT_NULL(b.directFrame(0));
+}
+
+/**
+ * The LittleFS path (seek and read) and the memory-mapped slot path
+ * (copied and zero-copy) see the same frames.
+ */
+static void test_file_and_mapped_sources_agree(void) {
+    const char* path = "/tmp/test_fseq_reader.fseq";
+    FILE* f = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(f);
+    TEST_ASSERT_EQUAL_size_t(v1.size(), fwrite(v1.data(), 1, v1.size(), f));
+    fclose(f);
+
+    StdioFileSource file;
+    MappedFileSource mapped;
+    FseqReader fileReader, mappedReader;
+    TEST_ASSERT_TRUE(file.open(path));
+    TEST_ASSERT_TRUE(mapped.open(path));
+    TEST_ASSERT_TRUE(fileReader.open(&file));
+    TEST_ASSERT_TRUE(mappedReader.open(&mapped));
+    static uint8_t copied[LOGICAL_CHANNELS];
+    for (uint32_t fr = 0; fr < FIXTURE_FRAMES; fr += 13) {
+        TEST_ASSERT_TRUE(fileReader.readFrame(fr, logical));
+        TEST_ASSERT_TRUE(mappedReader.readFrame(fr, copied));
+        const uint8_t* direct = mappedReader.directFrame(fr);
+        TEST_ASSERT_NOT_NULL(direct);
+        TEST_ASSERT_EQUAL_MEMORY(logical, copied, FIXTURE_CHANNELS);
+        TEST_ASSERT_EQUAL_MEMORY(logical, direct, FIXTURE_CHANNELS);
+    }
+    file.close();
+    mapped.close();
+    remove(path);
+}
+
+static void test_upload_header_check(void) {
+    TEST_ASSERT_NULL(checkShowHeader(v1.data(), v1.size()));
+    TEST_ASSERT_NULL(checkShowHeader(v2z.data(), v2z.size()));
+    TEST_ASSERT_NULL(checkShowHeader(v2s.data(), v2s.size()));
+
+    std::vector<uint8_t> zstd(v2z.begin(), v2z.begin() + 32);
+    zstd[20] = (zstd[20] & 0xF0) | FSEQ_COMPRESSION_ZSTD;
+    TEST_ASSERT_NOT_NULL(checkShowHeader(zstd.data(), zstd.size()));
+    TEST_ASSERT_NOT_NULL(checkShowHeader(v1.data(), 20));
+}
+
+static void test_rejects_non_fseq(void) {
+    std::vector<uint8_t> junk(64, 0x55);
+    MemorySource src(junk.data(), junk.size());
+    FseqReader reader;
+    TEST_ASSERT_FALSE(reader.open(&src));
+    TEST_ASSERT_EQUAL_STRING("Not an FSEQ file", reader.lastError());
+}
+
+int main(void) {
+    frames = makeFrames(FIXTURE_FRAMES, FIXTURE_CHANNELS);
+    v1 = buildV1(frames, FIXTURE_CHANNELS, FIXTURE_FRAMES);
+    v2z = buildV2(frames, FIXTURE_CHANNELS, FIXTURE_FRAMES, true, {});
+    v2s = buildSparse(frames, FIXTURE_FRAMES, sparseExpect);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_v1_decodes_every_frame);
+    RUN_TEST(test_v2_zlib_decodes_every_frame);
+    RUN_TEST(test_v2_sparse_places_ranges_at_their_channels);
+    RUN_TEST(test_v2_header_fields);
+    RUN_TEST(test_zlib_random_seek);
+    RUN_TEST(test_late_join_prefill);
+    RUN_TEST(test_frame_out_of_range_fails);
+    RUN_TEST(test_coalesce_bridges_small_gaps);
+    RUN_TEST(test_range_reads_keep_mapped_channels);
+    RUN_TEST(test_direct_frame_only_for_raw_mapped_data);
+    RUN_TEST(test_file_and_mapped_sources_agree);
+    RUN_TEST(test_upload_header_check);
+    RUN_TEST(test_rejects_non_fseq);
+    return UNITY_END();
+}
@@ -0,0 +1,81 @@
+/**
+ * LedOutput: strip layout, wire time per layout, and the mock driver
+ * stalling exactly when a layout does not fit the frame step.
+ */
+#include <unity.h>
+#include "LedOutput.h"
+
+#define STEP_US 20000
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static std::vector<LedStrip> strips(std::initializer_list<uint16_t> counts) {
+    std::vector<LedStrip> out;
+    for (uint16_t n : counts) {
+        LedStrip s;
+        s.pin = out.size();
+        s.count = n;
+        out.push_back(s);
+    }
+    return out;
+}
+
+static void test_wire_time(void) {
+    TEST_ASSERT_EQUAL_UINT32(100 * 30 + WS2812_LATCH_US, stripWireUs(100));
+    std::vector<LedStrip> two = strips({ 500, 500 });
+    TEST_ASSERT_TRUE(layoutStrips(two, 1000, 0));
+    TEST_ASSERT_EQUAL_UINT32(stripWireUs(500), outputWireUs(two));
+    // Four strips on two transmitters: two rounds
+    std::vector<LedStrip> four = strips({ 250, 250, 250, 250 });
+    TEST_ASSERT_TRUE(layoutStrips(four, 1000, 0));
+    TEST_ASSERT_EQUAL_UINT32(2 * stripWireUs(250), outputWireUs(four));
+}
+
+static void test_layout_cut_and_short(void) {
+    std::vector<LedStrip> cut = strips({ 80, 80 }), shortOf = strips({ 50 });
+    TEST_ASSERT_TRUE(layoutStrips(cut, 100, 2));
+    TEST_ASSERT_EQUAL_UINT16(80, cut[1].first);
+    TEST_ASSERT_EQUAL_UINT16(20, cut[1].count);
+    TEST_ASSERT_FALSE(layoutStrips(shortOf, 100, 2));
+}
+
+/**
+ * 500 frames at 20 ms: a layout fits exactly when the mock sends every
+ * frame without a stall.
+ */
+static void test_mock_stalls_only_when_too_slow(void) {
+    struct Layout { uint16_t leds; std::vector<LedStrip> strips; };
+    Layout layouts[] = {
+        { 100, strips({ 100 }) },
+        { 600, strips({ 600 }) },
+        { 1000, strips({ 1000 }) },
+        { 1000, strips({ 500, 500 }) },
+        { 1000, strips({ 250, 250, 250, 250 }) },
+        { 1024, strips({ 400, 400, 224 }) },
+    };
+    for (Layout& l : layouts) {
+        TEST_ASSERT_TRUE(layoutStrips(l.strips, l.leds, 0));
+        uint32_t wireUs = outputWireUs(l.strips);
+        bool fits = wireUs < STEP_US;
+
+        MockLedOutput out;
+        out.begin(l.strips);
+        for (uint32_t f = 0; f < 500; f++) {
+            out.setNow((uint64_t)f * STEP_US);
+            out.show(255);
+        }
+        TEST_ASSERT_EQUAL_UINT32(500, out.frames());
+        TEST_ASSERT_EQUAL(fits, out.stalls() == 0);
+        if (fits) TEST_ASSERT_EQUAL_UINT32(wireUs, out.maxBusyUs());
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_wire_time);
+    RUN_TEST(test_layout_cut_and_short);
+    RUN_TEST(test_mock_stalls_only_when_too_slow);
+    return UNITY_END();
+}
@@ -0,0 +1,55 @@
+/**
+ * PipelineMetrics: samples land in the right cumulative Prometheus
+ * buckets, with and without labels.
+ */
+#include <unity.h>
+#include <string>
+#include "PipelineMetrics.h"
+#include "ByteSource.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void contains(const std::string& text, const char* line) {
+    TEST_ASSERT_TRUE_MESSAGE(text.find(line) != std::string::npos, line);
+}
+
+static void test_stage_histograms(void) {
+    PipelineMetrics metrics;
+    const uint32_t samples[] = { 10, 50, 51, 400, 999, 30000, 70000 };
+    for (uint32_t us : samples) metrics.add(STAGE_MAP, us);
+
+    MemorySink sink;
+    TEST_ASSERT_TRUE(metrics.writePrometheus(sink, "lightshow_stage_seconds", "Time per frame pipeline stage"));
+    std::string text(sink.data.begin(), sink.data.end());
+    contains(text, "# TYPE lightshow_stage_seconds histogram\n");
+    contains(text, "lightshow_stage_seconds_bucket{stage=\"map\",le=\"0.000050\"} 2\n");
+    contains(text, "lightshow_stage_seconds_bucket{stage=\"map\",le=\"0.000500\"} 4\n");
+    contains(text, "lightshow_stage_seconds_bucket{stage=\"map\",le=\"0.001000\"} 5\n");
+    contains(text, "lightshow_stage_seconds_bucket{stage=\"map\",le=\"0.050000\"} 6\n");
+    contains(text, "lightshow_stage_seconds_bucket{stage=\"map\",le=\"+Inf\"} 7\n");
+    contains(text, "lightshow_stage_seconds_sum{stage=\"map\"} 0.101510\n");
+    contains(text, "lightshow_stage_seconds_count{stage=\"map\"} 7\n");
+    contains(text, "lightshow_stage_seconds_count{stage=\"seek\"} 0\n");
+}
+
+static void test_unlabeled_histogram_and_value(void) {
+    StageHistogram plain;
+    plain.add(120);
+    MemorySink sink;
+    TEST_ASSERT_TRUE(writePrometheusHistogram(sink, "lightshow_frame_lateness_seconds", nullptr, plain));
+    TEST_ASSERT_TRUE(writePrometheusValue(sink, "lightshow_frames_total", "counter", "Frames played", 42));
+    std::string text(sink.data.begin(), sink.data.end());
+    contains(text, "lightshow_frame_lateness_seconds_bucket{le=\"0.000250\"} 1\n");
+    contains(text, "lightshow_frame_lateness_seconds_count 1\n");
+    contains(text, "# TYPE lightshow_frames_total counter\n");
+    contains(text, "lightshow_frames_total 42\n");
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_stage_histograms);
+    RUN_TEST(test_unlabeled_histogram_and_value);
+    return UNITY_END();
+}
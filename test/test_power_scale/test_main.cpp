@@ -0,0 +1,85 @@
+/**
+ * PowerScale (.lsp): every stored scale equals FastLED's power limit on
+ * the mapped frame, and the header round trips.
+ */
+#include <unity.h>
+#include "../ShowFixtures.h"
+#include "PowerScale.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_header_round_trip(void) {
+    PowerHeader h, back;
+    h.frameCount = 3000;
+    h.showFingerprint = 0x5107;
+    h.configFingerprint = 0xC0F1;
+    uint8_t raw[POWER_HEADER_SIZE];
+    encodePowerHeader(h, raw);
+    TEST_ASSERT_TRUE(decodePowerHeader(raw, back));
+    TEST_ASSERT_EQUAL_UINT32(h.frameCount, back.frameCount);
+    TEST_ASSERT_EQUAL_UINT32(h.showFingerprint, back.showFingerprint);
+    TEST_ASSERT_EQUAL_UINT32(h.configFingerprint, back.configFingerprint);
+    raw[0] = 'X';
+    TEST_ASSERT_FALSE(decodePowerHeader(raw, back));
+}
+
+static void test_limit_brightness(void) {
+    TEST_ASSERT_EQUAL_UINT8(128, limitBrightness(1000, 128, 2500));    // Within the limit
+    TEST_ASSERT_EQUAL_UINT8(128, limitBrightness(5000, 128, 2500));    // Exactly at it
+    TEST_ASSERT_EQUAL_UINT8(64, limitBrightness(10000, 128, 2500));
+}
+
+/**
+ * 100 LEDs at brightness 128 and 500 mA.
+ */
+static void test_scales_match_fastled(void) {
+    const uint16_t n = 100;
+    const uint8_t brightness = 128;
+    const uint32_t maxMw = POWER_VOLTS * 500;
+
+    std::vector<LedMapping> mapping(n);
+    for (uint16_t i = 0; i < n; i++) mapping[i].channel = sampleChannels[i % 25];
+    std::vector<uint16_t> src(n);
+    std::vector<uint8_t> color(n);
+    LedMapTable map = { src.data(), color.data(), defaultColorLuts(), n };
+    compileLedMap(mapping, map);
+
+    std::vector<uint8_t> frames = makeFrames(FIXTURE_FRAMES, FIXTURE_CHANNELS);
+    std::vector<uint8_t> v1 = buildV1(frames, FIXTURE_CHANNELS, FIXTURE_FRAMES);
+    MemorySource source(v1.data(), v1.size());
+    FseqReader reader;
+    TEST_ASSERT_TRUE(reader.open(&source));
+
+    PowerHeader header;
+    header.frameCount = FIXTURE_FRAMES;
+    MemorySink sink;
+    PowerStats stats;
+    TEST_ASSERT_TRUE(compilePowerScales(reader, map, brightness, maxMw, header, sink, stats));
+    TEST_ASSERT_EQUAL_size_t(POWER_HEADER_SIZE + FIXTURE_FRAMES, sink.data.size());
+    TEST_ASSERT_GREATER_THAN(0, stats.limitedFrames);
+
+    std::vector<Rgb> pixels(n);
+    uint8_t lowest = brightness;
+    for (uint32_t f = 0; f < FIXTURE_FRAMES; f++) {
+        mapFrameToLeds(frames.data() + (size_t)f * FIXTURE_CHANNELS, map, pixels.data());
+        uint32_t r = 0, g = 0, b = 0;
+        for (const Rgb& p : pixels) { r += p.r; g += p.g; b += p.b; }
+        uint32_t mw = (r * 80 >> 8) + (g * 55 >> 8) + (b * 75 >> 8) + n * 5 + 125;
+        uint32_t requested = mw * brightness / 256;
+        uint8_t expect = requested > maxMw ? brightness * maxMw / requested : brightness;
+        TEST_ASSERT_EQUAL_UINT8(expect, sink.data[POWER_HEADER_SIZE + f]);
+        TEST_ASSERT_EQUAL_UINT8(expect, limitBrightness(unscaledPowerMw(pixels.data(), n), brightness, maxMw));
+        lowest = std::min(lowest, expect);
+    }
+    TEST_ASSERT_EQUAL_UINT8(lowest, stats.minBrightness);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_header_round_trip);
+    RUN_TEST(test_limit_brightness);
+    RUN_TEST(test_scales_match_fastled);
+    return UNITY_END();
+}
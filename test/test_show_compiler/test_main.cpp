@@ -0,0 +1,69 @@
+/**
+ * ShowCompiler (.lsc): the sidecar holds each LED's channel in LED order
+ * for every frame and plays back through the reader.
+ */
+#include <unity.h>
+#include "../ShowFixtures.h"
+#include "ShowCompiler.h"
+
+static std::vector<uint8_t> frames, sparseExpect, v2s;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_sidecar_holds_leds_in_order(void) {
+    std::vector<LedMapping> leds;
+    for (uint16_t ch : sampleChannels) leds.push_back({ ch });
+    leds.push_back({ 250 });    // Outside the sparse ranges: black
+    leds.push_back({ 9999 });   // Dead LED
+
+    MemorySource src(v2s.data(), v2s.size());
+    FseqReader reader;
+    TEST_ASSERT_TRUE(reader.open(&src));
+    MemorySink sink;
+    TEST_ASSERT_TRUE(compileSidecar(reader, leds, 0x5107, 0xC0F1, sink));
+    TEST_ASSERT_EQUAL_size_t(SIDECAR_HEADER_SIZE + (size_t)FIXTURE_FRAMES * leds.size(), sink.data.size());
+
+    MemorySource lsc(sink.data.data(), sink.data.size());
+    FseqReader sidecar;
+    TEST_ASSERT_TRUE(sidecar.open(&lsc));
+    TEST_ASSERT_EQUAL_UINT8(SHOW_CODEC_SIDECAR, sidecar.info().compression);
+    TEST_ASSERT_EQUAL_UINT32(leds.size(), sidecar.info().stride);
+    TEST_ASSERT_EQUAL_UINT32(FIXTURE_FRAMES, sidecar.info().frameCount);
+    TEST_ASSERT_EQUAL_UINT32(0x5107, sidecar.info().showFingerprint);
+    TEST_ASSERT_EQUAL_UINT32(0xC0F1, sidecar.info().configFingerprint);
+
+    static uint8_t frame[LOGICAL_CHANNELS];
+    for (uint32_t f = 0; f < FIXTURE_FRAMES; f++) {
+        TEST_ASSERT_TRUE(sidecar.readFrame(f, frame));
+        for (size_t i = 0; i < leds.size(); i++) {
+            uint16_t ch = leds[i].channel;
+            uint8_t expect = ch < FIXTURE_CHANNELS ? sparseExpect[(size_t)f * FIXTURE_CHANNELS + ch] : 0;
+            TEST_ASSERT_EQUAL_UINT8(expect, frame[i]);
+        }
+    }
+}
+
+static void test_truncated_sidecar_is_rejected(void) {
+    std::vector<LedMapping> leds = { { 139 }, { 164 } };
+    MemorySource src(v2s.data(), v2s.size());
+    FseqReader reader;
+    TEST_ASSERT_TRUE(reader.open(&src));
+    MemorySink sink;
+    TEST_ASSERT_TRUE(compileSidecar(reader, leds, 1, 2, sink));
+
+    MemorySource cut(sink.data.data(), sink.data.size() - 1);
+    FseqReader sidecar;
+    TEST_ASSERT_FALSE(sidecar.open(&cut));
+}
+
+int main(void) {
+    frames = makeFrames(FIXTURE_FRAMES, FIXTURE_CHANNELS);
+    v2s = buildSparse(frames, FIXTURE_FRAMES, sparseExpect);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_sidecar_holds_leds_in_order);
+    RUN_TEST(test_truncated_sidecar_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,48 @@
+/**
+ * ShowSlot: the slot header round trips; erased flash and shows larger
+ * than the slot are not taken for a valid slot.
+ */
+#include <unity.h>
+#include <string.h>
+#include "ShowSlot.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_header_round_trip(void) {
+    ShowSlotHeader h, back;
+    h.length = 123456;
+    h.fingerprint = 0x5107;
+    strcpy(h.name, "/show.fseq");
+    uint8_t raw[SLOT_HEADER_SIZE];
+    encodeSlotHeader(h, raw);
+    TEST_ASSERT_TRUE(decodeSlotHeader(raw, h.length + SLOT_HEADER_SIZE, back));
+    TEST_ASSERT_EQUAL_UINT32(h.length, back.length);
+    TEST_ASSERT_EQUAL_UINT32(h.fingerprint, back.fingerprint);
+    TEST_ASSERT_EQUAL_STRING(h.name, back.name);
+}
+
+static void test_erased_flash_is_empty(void) {
+    uint8_t erased[SLOT_HEADER_SIZE];
+    memset(erased, 0xFF, sizeof(erased));
+    ShowSlotHeader back;
+    TEST_ASSERT_FALSE(decodeSlotHeader(erased, 1 << 20, back));
+}
+
+static void test_show_larger_than_slot(void) {
+    ShowSlotHeader h, back;
+    h.length = 123456;
+    strcpy(h.name, "/show.fseq");
+    uint8_t raw[SLOT_HEADER_SIZE];
+    encodeSlotHeader(h, raw);
+    TEST_ASSERT_FALSE(decodeSlotHeader(raw, h.length, back));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_header_round_trip);
+    RUN_TEST(test_erased_flash_is_empty);
+    RUN_TEST(test_show_larger_than_slot);
+    return UNITY_END();
+}
@@ -0,0 +1,79 @@
+/**
+ * TimeSync: the offset estimate stays within 10 ms over a simulated WiFi
+ * link with jitter and stalls; the web UI sample format parses.
+ */
+#include <unity.h>
+#include <stdlib.h>
+#include "TimeSync.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_symmetric_round_is_exact(void) {
+    TimeSyncSample s = { 1000, 6000, 6100, 3100 };   // 1 ms each way, controller 4 ms ahead
+    TimeSyncResult res = estimateClockOffset(&s, 1);
+    TEST_ASSERT_TRUE(res.valid);
+    TEST_ASSERT_EQUAL_INT64(4000, res.offsetUs);
+    TEST_ASSERT_EQUAL_UINT32(2000, res.rttUs);
+}
+
+static void test_corrupt_rounds_are_ignored(void) {
+    TimeSyncSample s = { 5000, 6000, 6100, 1000 };   // Negative RTT
+    TEST_ASSERT_FALSE(estimateClockOffset(&s, 1).valid);
+    TEST_ASSERT_FALSE(estimateClockOffset(&s, 0).valid);
+}
+
+/**
+ * 12 rounds per sync, 3-30 ms path latency, 0-12 ms jitter per leg, one
+ * leg in four hit by a 50-250 ms stall, browser timestamps in whole ms.
+ */
+static void test_offset_error_over_wifi(void) {
+    const int trials = 1000, rounds = 12;
+    srand(11);
+    int64_t path = 0;
+    auto leg = [&path]() -> int64_t {
+        int64_t us = path + rand() % 12000;
+        if (rand() % 4 == 0) us += 50000 + rand() % 200000;
+        return us;
+    };
+    auto ms = [](int64_t us) { return us / 1000 * 1000; };
+
+    for (int t = 0; t < trials; t++) {
+        int64_t trueOffset = (int64_t)(rand() % 10000000) - 5000000;
+        int64_t browser = 1700000000000000LL + (int64_t)rand() * 1000;
+        path = 3000 + rand() % 27000;
+
+        TimeSyncSample samples[rounds];
+        for (int r = 0; r < rounds; r++) {
+            int64_t up = leg(), down = leg(), work = 100 + rand() % 2000;
+            samples[r].t1 = ms(browser);
+            samples[r].t2 = browser + up + trueOffset;
+            samples[r].t3 = samples[r].t2 + work;
+            browser += up + work + down;
+            samples[r].t4 = ms(browser);
+            browser += 1000 + rand() % 5000;
+        }
+        TimeSyncResult res = estimateClockOffset(samples, rounds);
+        TEST_ASSERT_TRUE(res.valid);
+        TEST_ASSERT_LESS_THAN(10000, llabs(res.offsetUs - trueOffset));
+    }
+}
+
+static void test_parse_samples(void) {
+    TimeSyncSample parsed[2];
+    TEST_ASSERT_EQUAL_size_t(2, parseTimeSyncSamples("1000,5000,5100,3000;2000,6000,6050,4100", parsed, 2));
+    TEST_ASSERT_EQUAL_INT64(1000, parsed[0].t1);
+    TEST_ASSERT_EQUAL_INT64(6050, parsed[1].t3);
+    TEST_ASSERT_EQUAL_INT64(4100, parsed[1].t4);
+    TEST_ASSERT_EQUAL_size_t(1, parseTimeSyncSamples("1000,5000,5100,3000;2000,6000,6050,4100", parsed, 1));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_symmetric_round_is_exact);
+    RUN_TEST(test_corrupt_rounds_are_ignored);
+    RUN_TEST(test_offset_error_over_wifi);
+    RUN_TEST(test_parse_samples);
+    return UNITY_END();
+}